@@ -4,6 +4,7 @@
 #include "Engine/Core/Thread.hpp"
 #include "Engine/Core/Logger.hpp"
 #include "Engine/Core/StringUtils.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
 #include "Engine/Math/MathUtils.hpp"
 #include <sstream>
 
@@ -47,7 +48,9 @@ Board::Board() {
 	m_depthScale = GetDepthScale(g_profile.get_device());
 
 	cv::namedWindow("test", cv::WINDOW_AUTOSIZE);
-	m_threadHandle = g_theThreadManager.CreateThread(&Board::ThreadWorker, this);
+	ThreadDesc_t threadDesc;
+	threadDesc.m_name = "Board Camera";
+	m_threadHandle = g_theThreadManager.CreateThread(threadDesc, &Board::ThreadWorker, this);
 }
 
 Board::~Board() {
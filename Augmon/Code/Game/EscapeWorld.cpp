@@ -8,6 +8,7 @@
 #include "Engine/Core/Camera.hpp"
 #include "Engine/Core/DebugDrawSystem.hpp"
 #include "ThirdParty/pugixml/pugixml.hpp"
+#include <queue>
 
 
 const Pattern_t EscapeWorld::s_monitorPattern(1, 1, { Rgba::GREEN });
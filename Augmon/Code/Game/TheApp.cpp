@@ -8,6 +8,7 @@
 #include "Engine/Core/DevConsole.hpp"
 #include "Engine/Core/ErrorWarningAssert.hpp"
 #include "Engine/Core/Thread.hpp"
+#include "Engine/Core/FrameAllocator.hpp"
 #include "Engine/Core/Logger.hpp"
 #include "Engine/Core/ResourceManager.hpp"
 #include "Engine/Core/DebugDrawSystem.hpp"
@@ -16,6 +17,7 @@
 #include "Game/TheApp.hpp"
 #include "Game/EscapeGame.hpp"
 #include "Game/ComposerGame.hpp"
+#include <fstream>
 
 std::unique_ptr<TheApp>		g_theApp;
 std::unique_ptr<RHIOutput>	g_thiefOutput;
@@ -210,6 +212,7 @@ void TheApp::RunFrame() {
 	PROFILE_SCOPE_FUNTION();
 
 	g_theMasterClock->BeginFrame();
+	g_theFrameAllocator.BeginFrame();
 	g_theInput->BeginFrame();
 	g_theAudio->BeginFrame();
 	Update();
@@ -8,6 +8,7 @@
 #include "Engine/Core/DevConsole.hpp"
 #include "Engine/Core/ErrorWarningAssert.hpp"
 #include "Engine/Core/Thread.hpp"
+#include "Engine/Core/FrameAllocator.hpp"
 #include "Engine/Core/Logger.hpp"
 #include "Engine/Core/DebugDrawSystem.hpp"
 #include "Engine/Core/ResourceManager.hpp"
@@ -18,6 +19,7 @@
 #include "Engine/Core/EventSystem.hpp"
 #include "Game/TheApp.hpp"
 #include "ThirdParty/pugixml/pugixml.hpp"
+#include <fstream>
 
 Uptr<TheApp> g_theApp;
 Uptr<RHIOutput> g_mainOutput;
@@ -225,8 +227,10 @@ void TheApp::LoadDefaultAssets() {
 void TheApp::RunFrame() {
 	g_theProfiler->MarkFrame();
 	g_theMasterClock->BeginFrame();
+	g_theFrameAllocator.BeginFrame();
 	g_theInput->BeginFrame();
 	g_theAudio->BeginFrame();
+	g_theEventSystem->DispatchQueuedEvents();
 	Update();
 	Render();
 	g_theAudio->EndFrame();
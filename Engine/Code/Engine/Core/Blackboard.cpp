@@ -1,135 +1,177 @@
 #include "Engine/Core/Blackboard.hpp"
 #include "Engine/Core/StringUtils.hpp"
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
 #include <string>
 #include "Engine/Core/ErrorWarningAssert.hpp"
 
+bool ParseBlackboardValue(const std::string& text, bool& outValue) {
+	outValue = text == "true";
+	return true;
+}
+
+bool ParseBlackboardValue(const std::string& text, int& outValue) {
+	const char* begin = text.c_str();
+	char* end = nullptr;
+	errno = 0;
+	long value = std::strtol(begin, &end, 10);
+	while (*end == ' ') end++;
+	if (end == begin || *end != '\0' || errno == ERANGE || value < INT_MIN || value > INT_MAX) {
+		return false;
+	}
+	outValue = (int)value;
+	return true;
+}
 
+bool ParseBlackboardValue(const std::string& text, float& outValue) {
+	const char* begin = text.c_str();
+	char* end = nullptr;
+	errno = 0;
+	float value = std::strtof(begin, &end);
+	while (*end == ' ') end++;
+	if (end == begin || *end != '\0' || errno == ERANGE) {
+		return false;
+	}
+	outValue = value;
+	return true;
+}
+
+bool ParseBlackboardValue(const std::string& text, Rgba& outValue) {
+	// SetFromText never gets past a character that isn't a number
+	if (text.find_first_not_of("0123456789, ") != std::string::npos) {
+		return false;
+	}
+	outValue.SetFromText(text.c_str());
+	return true;
+}
+
+bool ParseBlackboardValue(const std::string& text, Vector2& outValue) {
+	outValue.SetFromText(text.c_str());
+	return true;
+}
+
+bool ParseBlackboardValue(const std::string& text, IntVector2& outValue) {
+	outValue.SetFromText(text.c_str());
+	return true;
+}
+
+bool ParseBlackboardValue(const std::string& text, FloatRange& outValue) {
+	outValue.SetFromText(text.c_str());
+	return true;
+}
+
+bool ParseBlackboardValue(const std::string& text, IntRange& outValue) {
+	outValue.SetFromText(text.c_str());
+	return true;
+}
+
+//------------------------------------------------------------------------
 void Blackboard::PopulateFromXmlElementAttributes(const pugi::xml_node node) {
 	pugi::xml_node_iterator nodeIt = node.begin();
 	for (pugi::xml_attribute_iterator attrIt = nodeIt->attributes_begin(); attrIt != nodeIt->attributes_end(); ++attrIt) {
-		m_keyValuePairs.insert({attrIt->name(), attrIt->as_string()});
+		// the first one of a repeated attribute wins
+		Entry_t& entry = m_entries[CreateOrGetStringId(attrIt->name())];
+		if (!entry.m_hasText) {
+			entry.m_text = attrIt->as_string();
+			entry.m_hasText = true;
+			for (Uptr<BlackboardSlotBase>& slot : entry.m_slots) {
+				slot->Parse(entry.m_text);
+			}
+		}
 	}
 }
 
-void Blackboard::SetValue(const std::string& keyName, const std::string& newValue) {
-	auto iter = m_keyValuePairs.find(keyName);
-	if (iter != m_keyValuePairs.end()) {
-		iter->second = newValue;
+bool Blackboard::SetValue(const std::string& keyName, const std::string& newValue) {
+	StringId key = CreateOrGetStringId(keyName);
+	Entry_t& entry = m_entries[key];
+	// all or nothing, readers never see half a change
+	for (Uptr<BlackboardSlotBase>& slot : entry.m_slots) {
+		if (!slot->CanParse(newValue)) {
+			return false;
+		}
+	}
+	entry.m_text = newValue;
+	entry.m_hasText = true;
+	for (Uptr<BlackboardSlotBase>& slot : entry.m_slots) {
+		slot->Parse(entry.m_text);
+	}
+
+	// by index, a callback may watch or unwatch
+	for (size_t watcherIdx = 0; watcherIdx < m_watchers.size(); ++watcherIdx) {
+		if (m_watchers[watcherIdx].m_key == key || m_watchers[watcherIdx].m_key == INVALID_STRING_ID) {
+			WatchCallback callback = m_watchers[watcherIdx].m_callback;
+			callback(key, newValue);
+		}
 	}
+	return true;
 }
 
-bool Blackboard::GetValue(const std::string& keyName, bool defaultValue) const {
-	auto iter = m_keyValuePairs.find(keyName);
+u32 Blackboard::Watch(StringId key, WatchCallback callback) {
+	u32 watchId = m_nextWatchId++;
+	m_watchers.push_back({ watchId, key, std::move(callback) });
+	return watchId;
+}
 
-	if(iter != m_keyValuePairs.end()){
-		if(iter->second == "true"){
-			return true;
-		}
-		else{
-			return false;
+void Blackboard::Unwatch(u32 watchId) {
+	for (auto it = m_watchers.begin(); it != m_watchers.end(); ++it) {
+		if (it->m_id == watchId) {
+			m_watchers.erase(it);
+			return;
 		}
 	}
-	else{
-		return defaultValue;
+}
+
+const Blackboard::Entry_t* Blackboard::FindEntry(StringId key) const {
+	auto iter = m_entries.find(key);
+	if (iter == m_entries.end() || !iter->second.m_hasText) {
+		return nullptr;
 	}
+	return &iter->second;
+}
+
+//------------------------------------------------------------------------
+bool Blackboard::GetValue(const std::string& keyName, bool defaultValue) const {
+	return GetCachedValue(keyName, defaultValue);
 }
 
 int Blackboard::GetValue(const std::string& keyName, int defaultValue) const {
-	auto iter = m_keyValuePairs.find(keyName);
-	if (iter != m_keyValuePairs.end()){
-		return std::stoi(iter->second);
-	}
-	else{
-		return defaultValue;
-	}
+	return GetCachedValue(keyName, defaultValue);
 }
 
 float Blackboard::GetValue(const std::string& keyName, float defaultValue) const {
-	auto iter = m_keyValuePairs.find(keyName);
-	if (iter != m_keyValuePairs.end()) {
-		return std::stof(iter->second);
-	}
-	else {
-		return defaultValue;
-	}
+	return GetCachedValue(keyName, defaultValue);
 }
 
-std::string Blackboard::GetValue(const std::string& keyName, std::string defaultValue = nullptr) const {
-	auto iter = m_keyValuePairs.find(keyName);
-	if (iter != m_keyValuePairs.end()) {
-		return iter->second;
-	}
-	else {
-		return defaultValue;
-	}
+std::string Blackboard::GetValue(const std::string& keyName, std::string defaultValue) const {
+	const Entry_t* entry = FindEntry(HashStringId(keyName.c_str(), keyName.size()));
+	return entry ? entry->m_text : defaultValue;
 }
 
-std::string Blackboard::GetValue(const std::string& keyName, const char* defaultValue = nullptr) const {
-	auto iter = m_keyValuePairs.find(keyName);
-	if (iter != m_keyValuePairs.end()) {
-		return iter->second;
-	}
-	else {
-		return std::string(defaultValue);
+std::string Blackboard::GetValue(const std::string& keyName, const char* defaultValue) const {
+	const Entry_t* entry = FindEntry(HashStringId(keyName.c_str(), keyName.size()));
+	if (entry) {
+		return entry->m_text;
 	}
+	return defaultValue ? std::string(defaultValue) : std::string();
 }
 
 Rgba Blackboard::GetValue(const std::string& keyName, const Rgba& defaultValue) const {
-	auto iter = m_keyValuePairs.find(keyName);
-	if (iter != m_keyValuePairs.end()) {
-		Rgba rgba;
-		rgba.SetFromText(iter->second.c_str());
-		return rgba;
-	}
-	else {
-		return defaultValue;
-	}
+	return GetCachedValue(keyName, defaultValue);
 }
 
 Vector2 Blackboard::GetValue(const std::string& keyName, const Vector2& defaultValue) const {
-	auto iter = m_keyValuePairs.find(keyName);
-	if (iter != m_keyValuePairs.end()) {
-		Vector2 vector2;
-		vector2.SetFromText(iter->second.c_str());
-		return vector2;
-	}
-	else {
-		return defaultValue;
-	}
+	return GetCachedValue(keyName, defaultValue);
 }
 
 IntVector2 Blackboard::GetValue(const std::string& keyName, const IntVector2& defaultValue) const {
-	auto iter = m_keyValuePairs.find(keyName);
-	if (iter != m_keyValuePairs.end()) {
-		IntVector2 intVector2;
-		intVector2.SetFromText(iter->second.c_str());
-		return intVector2;
-	}
-	else {
-		return defaultValue;
-	}
+	return GetCachedValue(keyName, defaultValue);
 }
 
 FloatRange Blackboard::GetValue(const std::string& keyName, const FloatRange& defaultValue) const {
-	auto iter = m_keyValuePairs.find(keyName);
-	if (iter != m_keyValuePairs.end()) {
-		FloatRange floatRange;
-		floatRange.SetFromText(iter->second.c_str());
-		return floatRange;
-	}
-	else {
-		return defaultValue;
-	}
+	return GetCachedValue(keyName, defaultValue);
 }
 
 IntRange Blackboard::GetValue(const std::string& keyName, const IntRange& defaultValue) const {
-	auto iter = m_keyValuePairs.find(keyName);
-	if (iter != m_keyValuePairs.end()) {
-		IntRange intRange;
-		intRange.SetFromText(iter->second.c_str());
-		return intRange;
-	}
-	else {
-		return defaultValue;
-	}
-}
\ No newline at end of file
+	return GetCachedValue(keyName, defaultValue);
+}
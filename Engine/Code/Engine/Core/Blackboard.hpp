@@ -1,22 +1,89 @@
 #pragma once
-#include <map>
+#include <functional>
 #include <string>
+#include <unordered_map>
+#include <vector>
 #include "ThirdParty/pugixml/pugixml.hpp"
 
+#include "Engine/Core/type.hpp"
+#include "Engine/Core/StringId.hpp"
 #include "Engine/Core/Rgba.hpp"
 #include "Engine/Math/Vector2.hpp"
 #include "Engine/Math/IntVector2.hpp"
 #include "Engine/Math/FloatRange.hpp"
 #include "Engine/Math/IntRange.hpp"
 
+// text to value, false and outValue left alone if the text isn't one
+bool ParseBlackboardValue(const std::string& text, bool& outValue);
+bool ParseBlackboardValue(const std::string& text, int& outValue);
+bool ParseBlackboardValue(const std::string& text, float& outValue);
+bool ParseBlackboardValue(const std::string& text, Rgba& outValue);
+bool ParseBlackboardValue(const std::string& text, Vector2& outValue);
+bool ParseBlackboardValue(const std::string& text, IntVector2& outValue);
+bool ParseBlackboardValue(const std::string& text, FloatRange& outValue);
+bool ParseBlackboardValue(const std::string& text, IntRange& outValue);
 
+// A key's value parsed as one type, kept until the text changes.
+class BlackboardSlotBase {
+public:
+	explicit BlackboardSlotBase(TypeId typeId) : m_typeId(typeId) {}
+	virtual ~BlackboardSlotBase() = default;
+	// keeps the old value if the text doesn't parse
+	virtual bool Parse(const std::string& text) = 0;
+	virtual bool CanParse(const std::string& text) const = 0;
+
+	TypeId	m_typeId;
+	bool	m_hasValue = false;
+};
+
+template<typename T>
+class BlackboardSlot : public BlackboardSlotBase {
+public:
+	BlackboardSlot() : BlackboardSlotBase(GetTypeId<T>()) {}
+	bool Parse(const std::string& text) override {
+		if (!ParseBlackboardValue(text, m_value)) {
+			return false;
+		}
+		m_hasValue = true;
+		return true;
+	}
+	bool CanParse(const std::string& text) const override {
+		T value;
+		return ParseBlackboardValue(text, value);
+	}
+
+	T m_value = T();
+};
+
+// Cached read of one key, stays current when the value is set again.
+// Valid as long as the blackboard is.
+template<typename T>
+class BlackboardValue {
+public:
+	BlackboardValue() = default;
+	BlackboardValue(const BlackboardSlot<T>* slot, const T& defaultValue) : m_slot(slot), m_defaultValue(defaultValue) {}
+
+	const T& Get() const { return m_slot->m_hasValue ? m_slot->m_value : m_defaultValue; }
+
+private:
+	const BlackboardSlot<T>*	m_slot = nullptr;
+	T							m_defaultValue = T();
+};
+
+// Key value pairs, from xml or set at runtime.
+// Each value gets parsed once per type it is read as, on the first read, and again only when it's set.
+// Main thread only.
 class Blackboard{
 public:
+	using WatchCallback = std::function<void(StringId key, const std::string& newValue)>;
+
 	~Blackboard() = default;
 	Blackboard() {};
 
 	void			PopulateFromXmlElementAttributes(const pugi::xml_node node);
-	void			SetValue(const std::string& keyName, const std::string& newValue);
+	// adds the key if it's new, tells the watchers. False and nothing changes if
+	// the value can't be read as a type the key is read as
+	bool			SetValue(const std::string& keyName, const std::string& newValue);
 
 	bool			GetValue(const std::string& keyName, bool defaultValue) const;
 	int				GetValue(const std::string& keyName, int defaultValue) const;
@@ -29,6 +96,62 @@ public:
 	FloatRange		GetValue(const std::string& keyName, const FloatRange& defaultValue) const;
 	IntRange		GetValue(const std::string& keyName, const IntRange& defaultValue) const;
 
+	// for per frame reads, Get() on the handle is a couple of loads
+	template<typename T>
+	BlackboardValue<T> GetHandle(StringId key, const T& defaultValue) const { return BlackboardValue<T>(&CreateOrGetSlot<T>(key), defaultValue); }
+
+	// called on every SetValue of the key, or of any key for INVALID_STRING_ID. Returns an id for Unwatch
+	u32				Watch(StringId key, WatchCallback callback);
+	void			Unwatch(u32 watchId);
+
+private:
+	struct Entry_t {
+		std::string								m_text;
+		bool									m_hasText = false;
+		std::vector<Uptr<BlackboardSlotBase>>	m_slots;
+	};
+	struct Watcher_t {
+		u32				m_id;
+		StringId		m_key;
+		WatchCallback	m_callback;
+	};
+
+	const Entry_t*	FindEntry(StringId key) const;
+	template<typename T>
+	BlackboardSlot<T>& CreateOrGetSlot(StringId key) const;
+	template<typename T>
+	T GetCachedValue(const std::string& keyName, const T& defaultValue) const;
+
 private:
-	std::map<std::string, std::string> m_keyValuePairs;
-};
\ No newline at end of file
+	// slots are made on first read, entries never go away so handles stay valid
+	mutable std::unordered_map<StringId, Entry_t>	m_entries;
+	std::vector<Watcher_t>							m_watchers;
+	u32												m_nextWatchId = 1;
+};
+
+template<typename T>
+BlackboardSlot<T>& Blackboard::CreateOrGetSlot(StringId key) const {
+	Entry_t& entry = m_entries[key];
+	for (Uptr<BlackboardSlotBase>& slot : entry.m_slots) {
+		if (slot->m_typeId == GetTypeId<T>()) {
+			return *static_cast<BlackboardSlot<T>*>(slot.get());
+		}
+	}
+
+	BlackboardSlot<T>* slot = new BlackboardSlot<T>();
+	if (entry.m_hasText) {
+		slot->Parse(entry.m_text);
+	}
+	entry.m_slots.emplace_back(slot);
+	return *slot;
+}
+
+template<typename T>
+T Blackboard::GetCachedValue(const std::string& keyName, const T& defaultValue) const {
+	StringId key = HashStringId(keyName.c_str(), keyName.size());
+	if (FindEntry(key) == nullptr) {
+		return defaultValue;
+	}
+	const BlackboardSlot<T>& slot = CreateOrGetSlot<T>(key);
+	return slot.m_hasValue ? slot.m_value : defaultValue;
+}
@@ -0,0 +1,228 @@
+#include "Engine/Core/BlockAllocator.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+
+namespace {
+// both leaked on purpose, threads may exit after the statics are gone
+std::mutex& GetRegistryMutex() {
+	static std::mutex* s_mutex = new std::mutex();
+	return *s_mutex;
+}
+
+// both under the registry mutex, a slot is free again once its allocator dies
+BlockAllocator* s_blockAllocators[MAX_BLOCK_ALLOCATORS];
+u64 s_nextGeneration = 1;
+}
+
+// one cache per allocator, handed back to its allocator when the thread exits
+struct ThreadBlockCaches {
+	~ThreadBlockCaches() {
+		std::lock_guard<std::mutex> lock(GetRegistryMutex());
+		for (int allocatorIdx = 0; allocatorIdx < MAX_BLOCK_ALLOCATORS; ++allocatorIdx) {
+			BlockAllocator* allocator = s_blockAllocators[allocatorIdx];
+			BlockAllocator::Cache_t& cache = m_caches[allocatorIdx];
+			if (allocator && cache.m_generation == allocator->m_generation && (cache.m_numBlocks > 0 || cache.m_numAllocs > 0 || cache.m_numFrees > 0)) {
+				allocator->Release(cache, cache.m_numBlocks);
+			}
+		}
+	}
+
+	BlockAllocator::Cache_t m_caches[MAX_BLOCK_ALLOCATORS];
+};
+
+static thread_local ThreadBlockCaches s_threadBlockCaches;
+
+//------------------------------------------------------------------------
+BlockAllocator::BlockAllocator(const char* name, size_t blockSize, size_t alignment /*= 16*/, size_t blocksPerChunk /*= 256*/, eMemoryTag tag /*= MEMORY_TAG_GENERAL*/)
+	: m_name(name)
+	, m_alignment(alignment)
+	, m_blocksPerChunk(blocksPerChunk)
+	, m_tag(tag) {
+	GUARANTEE_OR_DIE(alignment > 0 && (alignment & (alignment - 1)) == 0 && alignment <= 256, "BlockAllocator - alignment must be a power of 2 up to 256!");
+	GUARANTEE_OR_DIE(blocksPerChunk > 0, "BlockAllocator - a chunk needs at least one block!");
+
+	// every block has to hold the free list link and keep the next block aligned
+	m_blockSize = AlignAddress(blockSize < sizeof(FreeBlock_t) ? sizeof(FreeBlock_t) : blockSize, alignment < alignof(FreeBlock_t) ? alignof(FreeBlock_t) : alignment);
+	m_stats.m_name = m_name;
+	m_stats.m_blockSize = m_blockSize;
+
+	// take the first free slot, the generation tells thread caches left over from its last owner apart
+	std::lock_guard<std::mutex> lock(GetRegistryMutex());
+	for (int allocatorIdx = 0; allocatorIdx < MAX_BLOCK_ALLOCATORS; ++allocatorIdx) {
+		if (s_blockAllocators[allocatorIdx] == nullptr) {
+			m_id = allocatorIdx;
+			break;
+		}
+	}
+	GUARANTEE_OR_DIE(m_id >= 0, "BlockAllocator - Too many block allocators alive, raise MAX_BLOCK_ALLOCATORS!");
+	m_generation = s_nextGeneration++;
+	s_blockAllocators[m_id] = this;
+}
+
+BlockAllocator::~BlockAllocator() {
+	{
+		std::lock_guard<std::mutex> lock(GetRegistryMutex());
+		s_blockAllocators[m_id] = nullptr;
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	for (void* chunk : m_chunks) {
+		FreeAligned(chunk);
+		TrackMemoryFree(m_tag, m_blockSize * m_blocksPerChunk);
+	}
+	m_chunks.clear();
+	m_freeList = nullptr;
+}
+
+void* BlockAllocator::Alloc() {
+	Cache_t& cache = GetThreadCache();
+	if (cache.m_head == nullptr) {
+		Refill(cache);
+	}
+
+	FreeBlock_t* block = cache.m_head;
+	cache.m_head = block->m_next;
+	--cache.m_numBlocks;
+	++cache.m_numAllocs;
+#if defined(_DEBUG)
+	FillWithPattern(block, m_blockSize, PATTERN_ALLOC);
+#endif
+	return block;
+}
+
+void BlockAllocator::Free(void* ptr) {
+	if (ptr == nullptr) {
+		return;
+	}
+
+#if defined(_DEBUG)
+	FillWithPattern(ptr, m_blockSize, PATTERN_FREE);
+#endif
+	Cache_t& cache = GetThreadCache();
+	FreeBlock_t* block = static_cast<FreeBlock_t*>(ptr);
+	block->m_next = cache.m_head;
+	cache.m_head = block;
+	++cache.m_numBlocks;
+	++cache.m_numFrees;
+
+	if (cache.m_numBlocks > BLOCK_CACHE_CAPACITY) {
+		Release(cache, BLOCK_CACHE_CAPACITY / 2);
+	}
+}
+
+void* BlockAllocator::Alloc(size_t size) {
+	if (size <= m_blockSize) {
+		return Alloc();
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		++m_stats.m_numOversizedAllocs;
+	}
+	return TrackingAllocator::Get(m_tag).Alloc(size);
+}
+
+void BlockAllocator::Free(void* ptr, size_t size) {
+	if (size <= m_blockSize) {
+		Free(ptr);
+	}
+	else {
+		TrackingAllocator::Get(m_tag).Free(ptr, size);
+	}
+}
+
+BlockAllocatorStats_t BlockAllocator::GetStats() const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_stats;
+}
+
+void BlockAllocator::GetAllStats(std::vector<BlockAllocatorStats_t>& out) {
+	std::lock_guard<std::mutex> lock(GetRegistryMutex());
+	for (int allocatorIdx = 0; allocatorIdx < MAX_BLOCK_ALLOCATORS; ++allocatorIdx) {
+		if (s_blockAllocators[allocatorIdx]) {
+			out.push_back(s_blockAllocators[allocatorIdx]->GetStats());
+		}
+	}
+}
+
+//------------------------------------------------------------------------
+BlockAllocator::Cache_t& BlockAllocator::GetThreadCache() const {
+	Cache_t& cache = s_threadBlockCaches.m_caches[m_id];
+	if (cache.m_generation != m_generation) {
+		// the slot's last owner is gone and its blocks went with its chunks, start over
+		cache = Cache_t();
+		cache.m_generation = m_generation;
+	}
+	return cache;
+}
+
+void BlockAllocator::Refill(Cache_t& cache) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	FoldStats(cache);
+
+	if (m_freeList == nullptr) {
+		AllocChunk();
+	}
+
+	// hand over up to a batch in one go
+	FreeBlock_t* first = m_freeList;
+	FreeBlock_t* last = first;
+	u32 numBlocks = 1;
+	while (numBlocks < BLOCK_CACHE_BATCH && last->m_next) {
+		last = last->m_next;
+		++numBlocks;
+	}
+	m_freeList = last->m_next;
+	last->m_next = cache.m_head;
+	cache.m_head = first;
+	cache.m_numBlocks += numBlocks;
+}
+
+void BlockAllocator::Release(Cache_t& cache, u32 numBlocks) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	FoldStats(cache);
+	if (numBlocks == 0) {
+		return;
+	}
+
+	FreeBlock_t* first = cache.m_head;
+	FreeBlock_t* last = first;
+	for (u32 blockIdx = 1; blockIdx < numBlocks; ++blockIdx) {
+		last = last->m_next;
+	}
+	cache.m_head = last->m_next;
+	cache.m_numBlocks -= numBlocks;
+	last->m_next = m_freeList;
+	m_freeList = first;
+}
+
+void BlockAllocator::FoldStats(Cache_t& cache) {
+	// a block can be freed on another thread than the one that got it, so only the totals make sense
+	m_stats.m_numAllocs += cache.m_numAllocs;
+	m_stats.m_numFrees += cache.m_numFrees;
+	cache.m_numAllocs = 0;
+	cache.m_numFrees = 0;
+
+	m_stats.m_numBlocksInUse = m_stats.m_numAllocs > m_stats.m_numFrees ? m_stats.m_numAllocs - m_stats.m_numFrees : 0;
+	if (m_stats.m_numBlocksInUse > m_stats.m_peakBlocksInUse) {
+		m_stats.m_peakBlocksInUse = m_stats.m_numBlocksInUse;
+	}
+}
+
+void BlockAllocator::AllocChunk() {
+	u8* chunk = (u8*)AllocAligned(m_blockSize * m_blocksPerChunk, m_alignment);
+	m_chunks.push_back(chunk);
+	TrackMemoryAlloc(m_tag, m_blockSize * m_blocksPerChunk);
+#if defined(_DEBUG)
+	FillWithPattern(chunk, m_blockSize * m_blocksPerChunk, PATTERN_FREE);
+#endif
+
+	// link back to front so blocks come out in address order
+	for (size_t blockIdx = m_blocksPerChunk; blockIdx > 0; --blockIdx) {
+		FreeBlock_t* block = reinterpret_cast<FreeBlock_t*>(chunk + (blockIdx - 1) * m_blockSize);
+		block->m_next = m_freeList;
+		m_freeList = block;
+	}
+
+	m_stats.m_numBlocksReserved += m_blocksPerChunk;
+	++m_stats.m_numChunks;
+}
@@ -1 +1,133 @@
 #pragma once
+#include "Engine/Core/TrackingAllocator.hpp"
+#include <mutex>
+#include <new>
+#include <vector>
+
+// block allocators alive at once, each one owns a slot in every thread's cache
+constexpr int MAX_BLOCK_ALLOCATORS = 64;
+// free blocks a thread keeps for itself, past that half of them go back to the shared list
+constexpr u32 BLOCK_CACHE_CAPACITY = 64;
+// free blocks a thread takes from the shared list at once
+constexpr u32 BLOCK_CACHE_BATCH = 32;
+
+struct BlockAllocatorStats_t {
+	const char*	m_name = nullptr;
+	size_t		m_blockSize = 0;
+	u64			m_numAllocs = 0;
+	u64			m_numFrees = 0;
+	u64			m_numBlocksInUse = 0;
+	u64			m_peakBlocksInUse = 0;
+	u64			m_numBlocksReserved = 0;	// carved out of chunks so far
+	u64			m_numChunks = 0;
+	u64			m_numOversizedAllocs = 0;	// didn't fit a block and went to the heap
+};
+
+// Hands out fixed size blocks carved from big aligned chunks. Free blocks are linked
+// through their own first bytes, so a block costs nothing on top of its size.
+// Every thread caches a few free blocks and only takes the lock to trade a batch with
+// the shared free list. Chunks go back to the heap when the allocator dies.
+class BlockAllocator {
+public:
+	BlockAllocator(const char* name, size_t blockSize, size_t alignment = 16, size_t blocksPerChunk = 256, eMemoryTag tag = MEMORY_TAG_GENERAL);
+	~BlockAllocator();
+	BlockAllocator(const BlockAllocator&) = delete;
+	BlockAllocator& operator=(const BlockAllocator&) = delete;
+
+	void* Alloc();
+	void Free(void* ptr);
+
+	// for class operator new/delete, sizes bigger than a block go to the heap
+	void* Alloc(size_t size);
+	void Free(void* ptr, size_t size);
+
+	const char* GetName() const { return m_name; }
+	size_t GetBlockSize() const { return m_blockSize; }
+	// each thread's counts are folded in whenever it trades with the shared list, so they lag a bit
+	BlockAllocatorStats_t GetStats() const;
+	static void GetAllStats(std::vector<BlockAllocatorStats_t>& out);
+
+private:
+	struct FreeBlock_t {
+		FreeBlock_t* m_next;
+	};
+
+	struct Cache_t {
+		FreeBlock_t*	m_head = nullptr;
+		u32				m_numBlocks = 0;
+		u64				m_numAllocs = 0;	// not folded into m_stats yet
+		u64				m_numFrees = 0;
+		u64				m_generation = 0;	// of the allocator the blocks belong to
+	};
+	friend struct ThreadBlockCaches;
+
+	Cache_t& GetThreadCache() const;
+	void Refill(Cache_t& cache);
+	void Release(Cache_t& cache, u32 numBlocks);
+	void FoldStats(Cache_t& cache);
+	void AllocChunk();
+
+private:
+	const char*					m_name;
+	size_t						m_blockSize;
+	size_t						m_alignment;
+	size_t						m_blocksPerChunk;
+	eMemoryTag					m_tag;
+	int							m_id = -1;
+	u64							m_generation = 0;	// slots get reused, this one is never
+
+	mutable std::mutex			m_mutex;
+	FreeBlock_t*				m_freeList = nullptr;
+	std::vector<void*>			m_chunks;
+	BlockAllocatorStats_t		m_stats;
+};
+
+// one pool for every element type of the same size and alignment
+template <size_t BlockSize, size_t Alignment>
+struct BlockAllocatorSTLPool {
+	static BlockAllocator& Get() {
+		static BlockAllocator* s_pool = new BlockAllocator("STL", BlockSize, Alignment);
+		return *s_pool;
+	}
+};
+
+// Standard allocator for node based containers (std::list, std::map, ...).
+// Single elements come from a pool shared by types of the same size, arrays go to the heap.
+// The pools are never destroyed, containers may still free into them at exit.
+template <typename T>
+class BlockAllocatorSTL {
+public:
+	typedef T value_type;
+
+	BlockAllocatorSTL() = default;
+	template <typename U>
+	BlockAllocatorSTL(const BlockAllocatorSTL<U>&) {}
+
+	T* allocate(size_t n) {
+		if (n == 1) {
+			return static_cast<T*>(GetPool().Alloc());
+		}
+		return static_cast<T*>(::operator new(n * sizeof(T)));
+	}
+
+	void deallocate(T* ptr, size_t n) {
+		if (n == 1) {
+			GetPool().Free(ptr);
+		}
+		else {
+			::operator delete(ptr);
+		}
+	}
+
+	static BlockAllocator& GetPool() {
+		// rounded the way BlockAllocator rounds it, so 40 and 48 byte nodes share a pool
+		constexpr size_t alignment = alignof(T) > 16 ? alignof(T) : 16;
+		return BlockAllocatorSTLPool<(sizeof(T) + alignment - 1) / alignment * alignment, alignment>::Get();
+	}
+};
+
+template <typename T, typename U>
+inline bool operator==(const BlockAllocatorSTL<T>&, const BlockAllocatorSTL<U>&) { return true; }
+
+template <typename T, typename U>
+inline bool operator!=(const BlockAllocatorSTL<T>&, const BlockAllocatorSTL<U>&) { return false; }
@@ -0,0 +1,57 @@
+#include "Engine/Core/ChromeTraceWriter.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Core/Time.hpp"
+
+double HPCToMicroseconds(u64 hpc, u64 originHPC) {
+	if (hpc < originHPC) {
+		return -PerformanceCountToSeconds(originHPC - hpc) * 1000000.0;
+	}
+	return PerformanceCountToSeconds(hpc - originHPC) * 1000000.0;
+}
+
+ChromeTraceWriter::ChromeTraceWriter(const std::string& filePath, const char* processName, u64 originHPC)
+	: m_os(filePath, std::ios::out | std::ios::trunc)
+	, m_originHPC(originHPC) {
+	if (!m_os) {
+		return;
+	}
+	m_isOpen = true;
+	m_os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	m_os << Stringf("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"%s\"}}", GetJsonEscapedString(processName).c_str());
+}
+
+ChromeTraceWriter::~ChromeTraceWriter() {
+	Finish();
+}
+
+void ChromeTraceWriter::WriteFrame(u64 startHPC, u64 endHPC) {
+	if (endHPC == 0) {
+		WriteEvent(Stringf("{\"name\":\"Frame\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":0,\"ts\":%.3f}", GetTimestamp(startHPC)));
+		return;
+	}
+	WriteEvent(Stringf("{\"name\":\"Frame\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":0,\"ts\":%.3f,\"args\":{\"ms\":%.3f}}",
+		GetTimestamp(startHPC), GetElapsedTime(startHPC, endHPC) * 1000.0));
+}
+
+void ChromeTraceWriter::WriteThread(int tid, const std::string& name) {
+	WriteEvent(Stringf("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+		tid, GetJsonEscapedString(name).c_str()));
+	WriteEvent(Stringf("{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"sort_index\":%d}}",
+		tid, tid));
+}
+
+void ChromeTraceWriter::WriteEvent(const std::string& eventJson) {
+	if (m_isOpen) {
+		m_os << ",\n" << eventJson;
+	}
+}
+
+bool ChromeTraceWriter::Finish() {
+	if (!m_isOpen) {
+		return false;
+	}
+	m_isOpen = false;
+	m_os << "\n]}\n";
+	m_os.close();
+	return !m_os.fail();
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include "Engine/Core/type.hpp"
+#include <fstream>
+#include <string>
+
+// microseconds from originHPC to hpc, negative if hpc is earlier
+double HPCToMicroseconds(u64 hpc, u64 originHPC);
+
+// Writes one process of a Chrome trace (chrome://tracing, ui.perfetto.dev).
+// Timestamps are counted from originHPC, events are written as they come and Finish closes the file.
+class ChromeTraceWriter {
+public:
+	ChromeTraceWriter(const std::string& filePath, const char* processName, u64 originHPC);
+	~ChromeTraceWriter();
+
+	bool	IsOpen() const { return m_isOpen; }
+	double	GetTimestamp(u64 hpc) const { return HPCToMicroseconds(hpc, m_originHPC); }
+
+	// frame start as a global instant event, with its length when it has an end
+	void	WriteFrame(u64 startHPC, u64 endHPC = 0);
+	// name and sort order of a thread, the name is escaped
+	void	WriteThread(int tid, const std::string& name);
+	// a whole event object, already in JSON
+	void	WriteEvent(const std::string& eventJson);
+	// false if anything failed to write
+	bool	Finish();
+
+private:
+	std::ofstream	m_os;
+	u64				m_originHPC;
+	bool			m_isOpen = false;
+};
@@ -1,6 +1,7 @@
 #include "Engine/Core/CommandDefinition.hpp"
 
 std::map<std::string, CommandDefinition*> CommandDefinition::s_commandDefintions;
+ReadWriteLock CommandDefinition::s_commandDefinitionsLock;
 
 CommandDefinition::CommandDefinition(std::string name, std::string description, command_cb cb) 
 	: m_name(name)
@@ -10,9 +11,22 @@ CommandDefinition::CommandDefinition(std::string name, std::string description,
 
 void CommandDefinition::Register(std::string cmdName, std::string description, command_cb cb) {
 	CommandDefinition* cmdDef = new CommandDefinition(cmdName, description, cb);
-	s_commandDefintions.insert({ cmdName, cmdDef });
+	WriteLockScope scope(s_commandDefinitionsLock);
+	if (!s_commandDefintions.insert({ cmdName, cmdDef }).second) {
+		delete cmdDef;
+	}
 }
 
-CommandDefinition* CommandDefinition::GetDefinition(std::string cmdName) {
-	return s_commandDefintions[cmdName];
+CommandDefinition* CommandDefinition::GetDefinition(const std::string& cmdName) {
+	ReadLockScope scope(s_commandDefinitionsLock);
+	auto it = s_commandDefintions.find(cmdName);
+	return it != s_commandDefintions.end() ? it->second : nullptr;
+}
+
+void CommandDefinition::GetAllDefinitions(std::vector<const CommandDefinition*>& out) {
+	ReadLockScope scope(s_commandDefinitionsLock);
+	out.reserve(out.size() + s_commandDefintions.size());
+	for (auto& it : s_commandDefintions) {
+		out.push_back(it.second);
+	}
 }
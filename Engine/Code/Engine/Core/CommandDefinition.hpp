@@ -1,7 +1,9 @@
 #pragma once
 #include "Engine/Core/Command.hpp"
+#include "Engine/Core/ThreadSafeContainer.hpp"
 #include <string>
 #include <map>
+#include <vector>
 
 typedef bool(*command_cb)(Command& cmd);
 
@@ -12,10 +14,17 @@ public:
 	CommandDefinition(std::string, std::string, command_cb);
 
 	static void Register(std::string cmdName,std::string description, command_cb cb);
-	static CommandDefinition* GetDefinition(std::string cmdName);
+	static CommandDefinition* GetDefinition(const std::string& cmdName);
+	// sorted by name, definitions are never removed so the pointers stay valid
+	static void GetAllDefinitions(std::vector<const CommandDefinition*>& out);
 
-public:
+	const std::string& GetName() const { return m_name; }
+	const std::string& GetDescription() const { return m_description; }
+
+private:
+	// commands register from any thread, lookups are far more common
 	static std::map<std::string, CommandDefinition*> s_commandDefintions;
+	static ReadWriteLock s_commandDefinitionsLock;
 
 private:
 	std::string m_name;
@@ -2,6 +2,7 @@
 #include "Engine/Core/DebugDrawSystem.hpp"
 #include "Engine/Core/Camera.hpp"
 #include "Engine/Core/ResourceManager.hpp"
+#include "Engine/Core/BlockAllocator.hpp"
 #include "Engine/Renderer/d3d11/RHIInstance.hpp"
 #include "Engine/Renderer/d3d11/ImmediateRenderer.hpp"
 #include "Engine/Renderer/d3d11/FontRenderer.hpp"
@@ -25,6 +26,20 @@ DebugObject::DebugObject(const DebugDrawOptions_t& options)
 
 DebugObject::~DebugObject() {}
 
+// never destroyed, g_theDebugDrawSystem may die after it during static destruction
+static BlockAllocator& GetDebugObjectPool() {
+	static BlockAllocator* s_pool = new BlockAllocator("DebugObject", 64, 16);
+	return *s_pool;
+}
+
+void* DebugObject::operator new(size_t size) {
+	return GetDebugObjectPool().Alloc(size);
+}
+
+void DebugObject::operator delete(void* ptr, size_t size) {
+	GetDebugObjectPool().Free(ptr, size);
+}
+
 void DebugObject::Update(float deltaSeconds) {
 	m_age += deltaSeconds;
 	m_color = Interpolate(m_options.m_startColor, m_options.m_endColor, GetNormalizedAge());
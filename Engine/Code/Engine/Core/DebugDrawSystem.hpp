@@ -39,6 +39,10 @@ public:
 	bool				IsDead() const;
 	float				GetNormalizedAge() const;
 
+	// every subclass shares one pool of cache line sized blocks, bigger ones use the heap
+	static void*		operator new(size_t size);
+	static void			operator delete(void* ptr, size_t size);
+
 public:
 	float				m_age = 0.f;
 	Rgba				m_color;
@@ -70,9 +70,14 @@ void DevConsole::Update(float deltaSeconds) {
 
 //	m_spriteAnim->Update(deltaSeconds);
 	// pop type safe queue, and push data to output window
-	ConsoleString cstr;
-	while (m_queue.Dequeue(cstr)) {
-		AppendOutputString(cstr);
+	m_queue.DequeueBatch(m_pendingStrings, m_queue.GetCapacity());
+	for (ConsoleString& cstr : m_pendingStrings) {
+		m_curOutputStrings.push_back(std::move(cstr));
+	}
+	m_pendingStrings.clear();
+	u32 numDroppedStrings = m_numDroppedStrings.exchange(0);
+	if (numDroppedStrings > 0) {
+		AppendOutputString(ConsoleString(Stringf("%u lines dropped, console queue was full.", numDroppedStrings), m_errorOutputColor));
 	}
 
 	UpdateInput();
@@ -229,16 +234,16 @@ void DevConsole::RenderAutoCompletionBox() const {
 }
 
 bool DevConsole::RunCommand(Command& cmd) {
-	for (auto it = CommandDefinition::s_commandDefintions.begin(); it != CommandDefinition::s_commandDefintions.end(); ++it) {
-		if (it->first == cmd.GetName()) {
-			command_cb callbackFunction = it->second->m_callback;
-			if (callbackFunction(cmd)) {
-				return true;
-			}
-			else {
-				ConsolePrintf(m_errorOutputColor, "%s: has invalid arguments!", cmd.GetName().c_str());
-				return false;
-			}
+	// the callback runs outside the table lock, it may register commands itself
+	CommandDefinition* cmdDef = CommandDefinition::GetDefinition(cmd.GetName());
+	if (cmdDef) {
+		command_cb callbackFunction = cmdDef->m_callback;
+		if (callbackFunction(cmd)) {
+			return true;
+		}
+		else {
+			ConsolePrintf(m_errorOutputColor, "%s: has invalid arguments!", cmd.GetName().c_str());
+			return false;
 		}
 	}
 	ConsolePrintf(m_errorOutputColor, "%s: Invalid command!", cmd.GetName().c_str());
@@ -351,8 +356,10 @@ void DevConsole::WriteClipBoard(const std::string& str) {
 
 bool DevConsole::ConsoleHelp(Command& cmd) {
 	if (cmd.m_args.empty()) {
-		for (auto& it : CommandDefinition::s_commandDefintions) {
-			ConsolePrintf("%s -%s", it.first.c_str(), it.second->m_description.c_str());
+		std::vector<const CommandDefinition*> cmdDefs;
+		CommandDefinition::GetAllDefinitions(cmdDefs);
+		for (const CommandDefinition* cmdDef : cmdDefs) {
+			ConsolePrintf("%s -%s", cmdDef->GetName().c_str(), cmdDef->GetDescription().c_str());
 		}
 		return true;
 	}
@@ -430,15 +437,17 @@ bool DevConsole::ConsoleMsgHandler(unsigned int msg, size_t wparam, size_t lpara
 
 void DevConsole::SearchForAutoCompletion() {
 	g_theConsole->ClearSearchResults();
-	for (auto& it : CommandDefinition::s_commandDefintions) {
-		const std::string& strInSearch = it.first;
+	std::vector<const CommandDefinition*> cmdDefs;
+	CommandDefinition::GetAllDefinitions(cmdDefs);
+	for (const CommandDefinition* cmdDef : cmdDefs) {
+		const std::string& strInSearch = cmdDef->GetName();
 		std::string& inputStr = g_theConsole->m_curInputString;
 		const std::string& subStrInSearch = strInSearch.substr(0, inputStr.length()); 
 		if (subStrInSearch == inputStr) {
 			g_theConsole->m_isAutoCompleting = true;
 
 			ConsoleString result(strInSearch, Rgba::WHITE);
-			result.m_cstrInfo = new ConsoleString(it.second->m_description, Rgba::WHITE);
+			result.m_cstrInfo = new ConsoleString(cmdDef->GetDescription(), Rgba::WHITE);
 			g_theConsole->AddSeachResult(result);
 		}
 	}
@@ -698,8 +707,10 @@ void ConsolePrintf(const char* format, ...) {
 	textLiteral[CONSOLE_STRINGF_LENGTH - 1] = '\0'; // In case vsnprintf overran (doesn't auto-terminate)
 
 	std::string str(textLiteral);
-	ConsoleString cstr(str, g_theConsole->m_defaultOutputTextColor);
-	g_theConsole->m_queue.Enqueue(std::move(cstr));
+	// the main thread drains the queue, it can't wait on itself when full
+	if (!g_theConsole->m_queue.TryEnqueue(ConsoleString(str, g_theConsole->m_defaultOutputTextColor))) {
+		++g_theConsole->m_numDroppedStrings;
+	}
 	
 	for(auto& hook : g_theConsole->m_hooks){
 		hook(str);
@@ -718,8 +729,10 @@ void ConsolePrintf(const Rgba& color, const char* format, ...) {
 	textLiteral[CONSOLE_STRINGF_LENGTH - 1] = '\0'; // In case vsnprintf overran (doesn't auto-terminate)
 
 	std::string str(textLiteral);
-	ConsoleString cstr(str, color);
-	g_theConsole->m_queue.Enqueue(std::move(cstr));
+	// the main thread drains the queue, it can't wait on itself when full
+	if (!g_theConsole->m_queue.TryEnqueue(ConsoleString(str, color))) {
+		++g_theConsole->m_numDroppedStrings;
+	}
 
 	for (auto& hook : g_theConsole->m_hooks) {
 		hook(str);
@@ -1,12 +1,16 @@
 #pragma once
 #include "Engine/Core/CommandDefinition.hpp"
-#include "Engine/Core/ThreadSafeContainer.hpp"
+#include "Engine/Core/RingQueue.hpp"
 #include "Engine/Core/Camera.hpp"
 #include "Engine/Core/struct.hpp"
+#include <atomic>
 #include <vector>
 #include <memory>
 #include <string>
 
+// lines printed between two updates, past that they are dropped and counted
+constexpr size_t CONSOLE_QUEUE_CAPACITY = 8192;
+
 typedef void(*console_printf_cb)(const std::string& data);
 
 class StopWatch;
@@ -70,7 +74,8 @@ public:
 	Rgba						m_defaultOutputTextColor = Rgba::GREEN;
 	Rgba						m_errorOutputColor = Rgba::RED;
 	static const int			MAX_HISTORY_STRINGS;
-	ThreadSafeQueue<ConsoleString> m_queue;
+	MPMCRingQueue<ConsoleString> m_queue{ CONSOLE_QUEUE_CAPACITY };
+	std::atomic<u32>			m_numDroppedStrings{ 0 };
 	std::vector<console_printf_cb> m_hooks;
 
 private:
@@ -88,6 +93,7 @@ private:
 	float						m_fontSize;
 	std::string					m_curInputString;
 	std::vector<ConsoleString>	m_curOutputStrings;
+	std::vector<ConsoleString>	m_pendingStrings;
 	std::vector<std::string>	m_historyStrings;
 
 	std::vector<ConsoleString>  m_matchedStrings;
@@ -37,8 +37,6 @@
 #define SAFE_DELETE_ARRAY( x ) {if(x){delete[] (x);(x)=nullptr;}}
 #define WITHIN_RANGE(val, left, right) (left <= val && val <= right)
 
-#define PROFILER_ENABLED
-
 constexpr size_t MAX_WINDOWS = 2;
 using namespace std::string_literals;
 
@@ -1,22 +1,26 @@
 #include "Engine/Core/EventSystem.hpp"
-#include "Engine/Core/ErrorWarningAssert.hpp"
+#include <algorithm>
 
 Uptr<EventSystem> g_theEventSystem;
 
-EventSystem::EventSystem() {
-
-}
-
-EventSystem::~EventSystem() {
-
+void EventSystem::UnSubscribeObject(const void* object) {
+	for (Uptr<EventChannelBase>& channel : m_channels) {
+		channel->RemoveObject(object);
+	}
 }
 
-void EventSystem::Subscribe(const std::string& eventName, const std::string& funcName) {
-	m_subscriptions[eventName].insert(funcName);
+void EventSystem::DispatchQueuedEvents() {
+	// whatever the subscribers queue goes to the next dispatch
+	m_dispatchOrder.swap(m_queueOrder);
+	for (EventChannelBase* channel : m_dispatchOrder) {
+		channel->DispatchNextQueued();
+	}
+	for (EventChannelBase* channel : m_dispatchOrder) {
+		channel->EndDispatch();
+	}
+	m_dispatchOrder.clear();
 }
 
-void EventSystem::UnSubscribe(const std::string& eventName, const std::string& funcName) {
-	if (m_subscriptions.find(eventName) != m_subscriptions.end()) {
-		m_subscriptions[eventName].erase(funcName);
-	}
+size_t EventSystem::FindChannelIndex(StringId eventId) const {
+	return std::lower_bound(m_channelIds.begin(), m_channelIds.end(), eventId) - m_channelIds.begin();
 }
@@ -1,34 +1,308 @@
 #pragma once
 #include "Engine/Core/type.hpp"
-#include "Engine/Core/EngineCommon.hpp"
-#include <unordered_map>
-#include <set>
+#include "Engine/Core/StringId.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include <algorithm>
+#include <cstring>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
+// big enough for a method pointer of a class with virtual inheritance
+constexpr size_t EVENT_CALLABLE_SIZE = 3 * sizeof(void*);
+
+// A subscriber, a free function or an object with one of its methods.
+// Kept by value, subscribing doesn't allocate anything but the slot.
+template<typename... Args>
+struct EventDelegate_t {
+	using Thunk = bool(*)(const EventDelegate_t&, const Args&...);
+
+	Thunk	m_thunk = nullptr;		// nullptr once unsubscribed in the middle of a fire
+	void*	m_object = nullptr;
+	char	m_callable[EVENT_CALLABLE_SIZE] = {};
+
+	bool operator==(const EventDelegate_t& rhs) const {
+		return m_thunk == rhs.m_thunk && m_object == rhs.m_object && memcmp(m_callable, rhs.m_callable, EVENT_CALLABLE_SIZE) == 0;
+	}
+};
+
+class EventChannelBase {
+public:
+	EventChannelBase(StringId eventId, TypeId argsTypeId) : m_eventId(eventId), m_argsTypeId(argsTypeId) {}
+	virtual ~EventChannelBase() = default;
+
+	StringId	GetEventId() const { return m_eventId; }
+	TypeId		GetArgsTypeId() const { return m_argsTypeId; }
+
+	virtual void DispatchNextQueued() = 0;
+	virtual void EndDispatch() = 0;
+	virtual void RemoveObject(const void* object) = 0;
+
+private:
+	StringId	m_eventId;
+	TypeId		m_argsTypeId;
+};
+
+// All subscribers of one event, they all take the same arguments.
+template<typename... Args>
+class EventChannel : public EventChannelBase {
+public:
+	using Delegate = EventDelegate_t<Args...>;
+
+	explicit EventChannel(StringId eventId) : EventChannelBase(eventId, GetTypeId<EventChannel>()) {}
+
+	void Add(const Delegate& delegate);
+	void Remove(const Delegate& delegate);
+	// in subscribe order, stops at the first one that returns true
+	bool Fire(const Args&... args);
+	template<typename... Ts>
+	void Queue(Ts&&... args) { m_queued.emplace_back(std::forward<Ts>(args)...); }
+
+	void DispatchNextQueued() override;
+	void EndDispatch() override;
+	void RemoveObject(const void* object) override;
+
+private:
+	template<size_t... Indices>
+	void FireQueued(const std::tuple<Args...>& args, std::index_sequence<Indices...>) { Fire(std::get<Indices>(args)...); }
+	void RemoveDeadDelegates();
+
+private:
+	std::vector<Delegate>				m_delegates;
+	std::vector<std::tuple<Args...>>	m_queued;
+	size_t								m_numDispatched = 0;
+	int									m_fireDepth = 0;
+	bool								m_hasDeadDelegates = false;
+};
+
+// Events are named by StringId, use SID("OnSomething").
+// Subscribers return true to consume the event. An event's arguments are fixed by the first
+// subscribe, fire or queue, using other argument types later on dies.
+// Main thread only.
 class EventSystem {
 public:
-	EventSystem();
-	~EventSystem();
+	EventSystem() = default;
+	~EventSystem() = default;
+	EventSystem(const EventSystem&) = delete;
+	EventSystem& operator=(const EventSystem&) = delete;
+
+	template<typename... Params>
+	void Subscribe(StringId eventId, bool (*function)(Params...));
+	template<typename T, typename... Params>
+	void Subscribe(StringId eventId, T* object, bool (T::*method)(Params...));
+	template<typename... Params>
+	void UnSubscribe(StringId eventId, bool (*function)(Params...));
+	template<typename T, typename... Params>
+	void UnSubscribe(StringId eventId, T* object, bool (T::*method)(Params...));
+	// every method of the object on every event, for destructors
+	void UnSubscribeObject(const void* object);
 
-	void Subscribe(const std::string& eventName, const std::string& funcName);
-	void UnSubscribe(const std::string& eventName, const std::string& funcName);
-    
+	// calls the subscribers right away, true if one of them consumed the event
 	template<typename... Args>
-	void FireEvents(const std::string& eventName, Args&&... args);
+	bool FireEvent(StringId eventId, const Args&... args);
+	// the arguments are copied, the subscribers get called in DispatchQueuedEvents
+	template<typename... Args>
+	void QueueEvent(StringId eventId, Args&&... args);
+	// once per frame, in queue order. Events queued meanwhile wait for the next one
+	void DispatchQueuedEvents();
 
 private:
- 	std::unordered_map<std::string, std::set<std::string>> m_subscriptions;
+	template<typename... Args>
+	EventChannel<Args...>* FindChannel(StringId eventId) const;
+	template<typename... Args>
+	EventChannel<Args...>& CreateOrGetChannel(StringId eventId);
+	size_t FindChannelIndex(StringId eventId) const;
+
+	template<typename Function, typename... Args>
+	static bool CallFunction(const EventDelegate_t<Args...>& delegate, const Args&... args);
+	template<typename T, typename Method, typename... Args>
+	static bool CallMethod(const EventDelegate_t<Args...>& delegate, const Args&... args);
+	template<typename Function, typename... Args>
+	static EventDelegate_t<Args...> MakeDelegate(typename EventDelegate_t<Args...>::Thunk thunk, void* object, const Function& callable);
+
+private:
+	// sorted by id, m_channels matches index for index
+	std::vector<StringId>					m_channelIds;
+	std::vector<Uptr<EventChannelBase>>		m_channels;
+	std::vector<EventChannelBase*>			m_queueOrder;
+	std::vector<EventChannelBase*>			m_dispatchOrder;
 };
 
+extern Uptr<EventSystem> g_theEventSystem;
+
+//------------------------------------------------------------------------
+template<typename... Args>
+void EventChannel<Args...>::Add(const Delegate& delegate) {
+	m_delegates.push_back(delegate);
+}
+
 template<typename... Args>
-void EventSystem::FireEvents(const std::string& eventName, Args&&... args) {
-	if (m_subscriptions.find(eventName) != m_subscriptions.end()) {
-		for (auto& it : m_subscriptions[eventName]) {
-			bool consumeEvents = g_functionLibrary.Invoke<bool>(it, std::forward<Args>(args)...);
-			if (consumeEvents) {
-				break;
+void EventChannel<Args...>::Remove(const Delegate& delegate) {
+	for (size_t delegateIdx = 0; delegateIdx < m_delegates.size(); ++delegateIdx) {
+		if (m_delegates[delegateIdx] == delegate) {
+			if (m_fireDepth > 0) {
+				// a fire further up the stack is walking the array
+				m_delegates[delegateIdx].m_thunk = nullptr;
+				m_hasDeadDelegates = true;
+			}
+			else {
+				m_delegates.erase(m_delegates.begin() + delegateIdx);
 			}
+			return;
+		}
+	}
+}
+
+template<typename... Args>
+void EventChannel<Args...>::RemoveObject(const void* object) {
+	for (Delegate& delegate : m_delegates) {
+		if (delegate.m_object == object) {
+			delegate.m_thunk = nullptr;
+			m_hasDeadDelegates = true;
+		}
+	}
+	if (m_fireDepth == 0) {
+		RemoveDeadDelegates();
+	}
+}
+
+template<typename... Args>
+bool EventChannel<Args...>::Fire(const Args&... args) {
+	bool isConsumed = false;
+	++m_fireDepth;
+	// subscribers added by a subscriber only see the next fire
+	size_t numDelegates = m_delegates.size();
+	for (size_t delegateIdx = 0; delegateIdx < numDelegates; ++delegateIdx) {
+		// copied, a subscribe can move the array
+		Delegate delegate = m_delegates[delegateIdx];
+		if (delegate.m_thunk && delegate.m_thunk(delegate, args...)) {
+			isConsumed = true;
+			break;
 		}
 	}
+	if (--m_fireDepth == 0) {
+		RemoveDeadDelegates();
+	}
+	return isConsumed;
+}
+
+template<typename... Args>
+void EventChannel<Args...>::DispatchNextQueued() {
+	// moved out, a subscriber queueing the same event can move the array
+	std::tuple<Args...> args = std::move(m_queued[m_numDispatched++]);
+	FireQueued(args, std::index_sequence_for<Args...>());
+}
+
+template<typename... Args>
+void EventChannel<Args...>::EndDispatch() {
+	if (m_numDispatched == m_queued.size()) {
+		// keeps the capacity for the next frame
+		m_queued.clear();
+	}
+	else {
+		m_queued.erase(m_queued.begin(), m_queued.begin() + m_numDispatched);
+	}
+	m_numDispatched = 0;
+}
+
+template<typename... Args>
+void EventChannel<Args...>::RemoveDeadDelegates() {
+	if (m_hasDeadDelegates) {
+		m_delegates.erase(std::remove_if(m_delegates.begin(), m_delegates.end(), [](const Delegate& delegate) { return delegate.m_thunk == nullptr; }), m_delegates.end());
+		m_hasDeadDelegates = false;
+	}
+}
+
+//------------------------------------------------------------------------
+template<typename... Params>
+void EventSystem::Subscribe(StringId eventId, bool (*function)(Params...)) {
+	using Function = bool(*)(Params...);
+	CreateOrGetChannel<std::decay_t<Params>...>(eventId).Add(
+		MakeDelegate<Function, std::decay_t<Params>...>(&CallFunction<Function, std::decay_t<Params>...>, nullptr, function));
+}
+
+template<typename T, typename... Params>
+void EventSystem::Subscribe(StringId eventId, T* object, bool (T::*method)(Params...)) {
+	using Method = bool (T::*)(Params...);
+	CreateOrGetChannel<std::decay_t<Params>...>(eventId).Add(
+		MakeDelegate<Method, std::decay_t<Params>...>(&CallMethod<T, Method, std::decay_t<Params>...>, object, method));
+}
+
+template<typename... Params>
+void EventSystem::UnSubscribe(StringId eventId, bool (*function)(Params...)) {
+	using Function = bool(*)(Params...);
+	EventChannel<std::decay_t<Params>...>* channel = FindChannel<std::decay_t<Params>...>(eventId);
+	if (channel) {
+		channel->Remove(MakeDelegate<Function, std::decay_t<Params>...>(&CallFunction<Function, std::decay_t<Params>...>, nullptr, function));
+	}
 }
 
-extern Uptr<EventSystem> g_theEventSystem;
\ No newline at end of file
+template<typename T, typename... Params>
+void EventSystem::UnSubscribe(StringId eventId, T* object, bool (T::*method)(Params...)) {
+	using Method = bool (T::*)(Params...);
+	EventChannel<std::decay_t<Params>...>* channel = FindChannel<std::decay_t<Params>...>(eventId);
+	if (channel) {
+		channel->Remove(MakeDelegate<Method, std::decay_t<Params>...>(&CallMethod<T, Method, std::decay_t<Params>...>, object, method));
+	}
+}
+
+template<typename... Args>
+bool EventSystem::FireEvent(StringId eventId, const Args&... args) {
+	EventChannel<std::decay_t<Args>...>* channel = FindChannel<std::decay_t<Args>...>(eventId);
+	return channel ? channel->Fire(args...) : false;
+}
+
+template<typename... Args>
+void EventSystem::QueueEvent(StringId eventId, Args&&... args) {
+	EventChannel<std::decay_t<Args>...>& channel = CreateOrGetChannel<std::decay_t<Args>...>(eventId);
+	channel.Queue(std::forward<Args>(args)...);
+	m_queueOrder.push_back(&channel);
+}
+
+template<typename... Args>
+EventChannel<Args...>* EventSystem::FindChannel(StringId eventId) const {
+	size_t channelIdx = FindChannelIndex(eventId);
+	if (channelIdx == m_channelIds.size() || m_channelIds[channelIdx] != eventId) {
+		return nullptr;
+	}
+	EventChannelBase* channel = m_channels[channelIdx].get();
+	GUARANTEE_OR_DIE(channel->GetArgsTypeId() == GetTypeId<EventChannel<Args...>>(), "EventSystem - Event used with other argument types than before!");
+	return static_cast<EventChannel<Args...>*>(channel);
+}
+
+template<typename... Args>
+EventChannel<Args...>& EventSystem::CreateOrGetChannel(StringId eventId) {
+	EventChannel<Args...>* channel = FindChannel<Args...>(eventId);
+	if (channel == nullptr) {
+		size_t channelIdx = FindChannelIndex(eventId);
+		channel = new EventChannel<Args...>(eventId);
+		m_channelIds.insert(m_channelIds.begin() + channelIdx, eventId);
+		m_channels.emplace(m_channels.begin() + channelIdx, channel);
+	}
+	return *channel;
+}
+
+template<typename Function, typename... Args>
+bool EventSystem::CallFunction(const EventDelegate_t<Args...>& delegate, const Args&... args) {
+	Function function;
+	memcpy(&function, delegate.m_callable, sizeof(Function));
+	return function(args...);
+}
+
+template<typename T, typename Method, typename... Args>
+bool EventSystem::CallMethod(const EventDelegate_t<Args...>& delegate, const Args&... args) {
+	Method method;
+	memcpy(&method, delegate.m_callable, sizeof(Method));
+	return (static_cast<T*>(delegate.m_object)->*method)(args...);
+}
+
+template<typename Function, typename... Args>
+EventDelegate_t<Args...> EventSystem::MakeDelegate(typename EventDelegate_t<Args...>::Thunk thunk, void* object, const Function& callable) {
+	static_assert(sizeof(Function) <= EVENT_CALLABLE_SIZE, "EventSystem - Callable does not fit in a delegate");
+	EventDelegate_t<Args...> delegate;
+	delegate.m_thunk = thunk;
+	delegate.m_object = object;
+	memcpy(delegate.m_callable, &callable, sizeof(Function));
+	return delegate;
+}
@@ -0,0 +1,44 @@
+#include "Engine/Core/FrameAllocator.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+
+FrameAllocator g_theFrameAllocator;
+
+FrameAllocator::FrameAllocator(size_t sizePerFrame /*= FRAME_ALLOCATOR_SIZE*/) {
+	m_stacks[0] = std::make_unique<StackAllocator>(sizePerFrame);
+	m_stacks[1] = std::make_unique<StackAllocator>(sizePerFrame);
+}
+
+void FrameAllocator::BeginFrame() {
+	size_t usedSize = GetUsedSize();
+	if (usedSize > m_peakUsedSize) {
+		m_peakUsedSize = usedSize;
+	}
+
+	// the stack of two frames ago becomes this frame's
+	u64 frameIdx = m_frameIdx.load(std::memory_order_relaxed) + 1;
+	m_stacks[frameIdx & 1]->Clear();
+	m_frameIdx.store(frameIdx, std::memory_order_release);
+}
+
+void* FrameAllocator::Alloc(size_t size, size_t alignment /*= 8*/) {
+	void* ptr = GetCurrentStack().Alloc(size, alignment);
+	GUARANTEE_OR_DIE(ptr != nullptr, "FrameAllocator::Alloc - Out of frame memory, raise FRAME_ALLOCATOR_SIZE!");
+	return ptr;
+}
+
+FrameMarker_t FrameAllocator::GetMarker() const {
+	FrameMarker_t marker;
+	marker.m_frameIdx = m_frameIdx.load(std::memory_order_relaxed);
+	marker.m_offset = m_stacks[marker.m_frameIdx & 1]->GetMarker();
+	return marker;
+}
+
+void FrameAllocator::FreeToMarker(const FrameMarker_t& marker) {
+	if (marker.m_frameIdx == m_frameIdx.load(std::memory_order_relaxed)) {
+		m_stacks[marker.m_frameIdx & 1]->FreeToMarker(marker.m_offset);
+	}
+}
+
+size_t FrameAllocator::GetUsedSize() const {
+	return GetCurrentStack().GetUsedSize();
+}
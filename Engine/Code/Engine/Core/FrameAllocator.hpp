@@ -0,0 +1,84 @@
+#pragma once
+#include "Engine/Core/StackAllocator.hpp"
+#include <memory>
+#include <type_traits>
+
+// size of each of the two frame buffers
+constexpr size_t FRAME_ALLOCATOR_SIZE = 4 * 1024 * 1024;
+
+struct FrameMarker_t {
+	u64		m_frameIdx = 0;
+	size_t	m_offset = 0;
+};
+
+// Scratch memory that lives until the end of the next frame and is dropped in bulk by BeginFrame.
+// Two stacks take turns, so what was allocated last frame stays valid while this one runs.
+// Any thread may Alloc; BeginFrame and FreeToMarker belong to the main thread.
+class FrameAllocator {
+public:
+	explicit FrameAllocator(size_t sizePerFrame = FRAME_ALLOCATOR_SIZE);
+
+	void BeginFrame();
+
+	void* Alloc(size_t size, size_t alignment = 8);
+	template <typename T>
+	T* AllocArray(size_t count);	// nothing is constructed or destroyed
+
+	FrameMarker_t GetMarker() const;
+	void FreeToMarker(const FrameMarker_t& marker);	// does nothing once the frame is over
+
+	size_t GetUsedSize() const;
+	size_t GetPeakUsedSize() const { return m_peakUsedSize; }
+
+private:
+	StackAllocator& GetCurrentStack() const { return *m_stacks[m_frameIdx.load(std::memory_order_acquire) & 1]; }
+
+private:
+	Uptr<StackAllocator>	m_stacks[2];
+	std::atomic<u64>		m_frameIdx{ 0 };
+	size_t					m_peakUsedSize = 0;
+};
+
+extern FrameAllocator g_theFrameAllocator;
+
+template <typename T>
+T* FrameAllocator::AllocArray(size_t count) {
+	static_assert(std::is_trivially_destructible<T>::value, "FrameAllocator never runs destructors");
+	return static_cast<T*>(Alloc(sizeof(T) * count, alignof(T)));
+}
+
+// Drops everything the frame allocator handed out inside the scope when it ends.
+// Only use it when no other thread allocates from the frame meanwhile.
+class FrameAllocatorScope {
+public:
+	explicit FrameAllocatorScope(FrameAllocator& allocator = g_theFrameAllocator)
+		: m_allocator(allocator)
+		, m_marker(allocator.GetMarker()) {}
+	~FrameAllocatorScope() { m_allocator.FreeToMarker(m_marker); }
+	FrameAllocatorScope(const FrameAllocatorScope&) = delete;
+	FrameAllocatorScope& operator=(const FrameAllocatorScope&) = delete;
+
+private:
+	FrameAllocator&		m_allocator;
+	FrameMarker_t		m_marker;
+};
+
+// Standard allocator for containers that don't outlive the next frame, deallocate is a no-op
+template <typename T>
+class FrameAllocatorSTL {
+public:
+	typedef T value_type;
+
+	FrameAllocatorSTL() = default;
+	template <typename U>
+	FrameAllocatorSTL(const FrameAllocatorSTL<U>&) {}
+
+	T* allocate(size_t n) { return static_cast<T*>(g_theFrameAllocator.Alloc(n * sizeof(T), alignof(T))); }
+	void deallocate(T*, size_t) {}
+};
+
+template <typename T, typename U>
+inline bool operator==(const FrameAllocatorSTL<T>&, const FrameAllocatorSTL<U>&) { return true; }
+
+template <typename T, typename U>
+inline bool operator!=(const FrameAllocatorSTL<T>&, const FrameAllocatorSTL<U>&) { return false; }
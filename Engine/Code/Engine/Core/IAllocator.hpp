@@ -5,6 +5,15 @@ constexpr u8 PATTERN_ALIGN = 0xFC;
 constexpr u8 PATTERN_ALLOC = 0xFD;
 constexpr u8 PATTERN_FREE = 0xFE;
 
+// Anything that hands out memory, allocators can wrap one another.
+// Free gets the same size and alignment that went into Alloc.
+class IAllocator {
+public:
+	virtual ~IAllocator() = default;
+	virtual void* Alloc(size_t size, size_t alignment = 16) = 0;
+	virtual void Free(void* ptr, size_t size, size_t alignment = 16) = 0;
+};
+
 inline size_t AlignAddress(size_t addr, size_t alignment) {
 	size_t mask = alignment - 1;
 
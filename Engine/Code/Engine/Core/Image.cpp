@@ -16,6 +16,17 @@ Image::Image(const std::string& imageFileName, bool flipY) {
 	stbi_set_flip_vertically_on_load(flipY);
 	m_imageData = stbi_load(imageFilePath.c_str(), &m_dimensions.x, &m_dimensions.y, &m_numComponents, numComponentsRequested);
 	GUARANTEE_OR_DIE((m_dimensions.x != 0.f) && (m_dimensions.y != 0.f), "Failed to load image.");
+	TrackMemoryAlloc(MEMORY_TAG_RESOURCES, GetImageDataSize());
+	PopulateFromData(m_imageData, m_dimensions, m_numComponents);
+}
+
+Image::Image(const std::vector<char>& fileData, bool flipY) {
+	int numComponentsRequested = 4; // we support 4 (RGBA)
+
+	stbi_set_flip_vertically_on_load(flipY);
+	m_imageData = stbi_load_from_memory((const stbi_uc*)fileData.data(), (int)fileData.size(), &m_dimensions.x, &m_dimensions.y, &m_numComponents, numComponentsRequested);
+	GUARANTEE_OR_DIE((m_dimensions.x != 0.f) && (m_dimensions.y != 0.f), "Failed to load image.");
+	TrackMemoryAlloc(MEMORY_TAG_RESOURCES, GetImageDataSize());
 	PopulateFromData(m_imageData, m_dimensions, m_numComponents);
 }
 
@@ -27,6 +38,9 @@ Image::Image()
 }
 
 Image::~Image() {
+	if (m_imageData) {
+		TrackMemoryFree(MEMORY_TAG_RESOURCES, GetImageDataSize());
+	}
 	stbi_image_free(m_imageData);
 }
 
@@ -1,6 +1,7 @@
 #pragma once
 #include "Engine/Core/Rgba.hpp"
 #include "Engine/Core/type.hpp"
+#include "Engine/Core/TrackingAllocator.hpp"
 #include "Engine/Math/IntVector2.hpp"
 #include <vector>
 #include <string>
@@ -10,6 +11,7 @@ class Image{
 public:
 	Image();
 	explicit Image(const std::string& imageFileName, bool flipY = false);  // origin is at top left corner by default
+	explicit Image(const std::vector<char>& fileData, bool flipY = false);  // an image file already read into memory
 	~Image();
 
 	void*	GetBuffer(u32 x, u32 y) const;
@@ -20,10 +22,11 @@ public:
 
 private:
 	void	PopulateFromData(unsigned char* imageData, const IntVector2& texelSize, int numComponents);
+	size_t	GetImageDataSize() const { return (size_t)m_dimensions.x * (size_t)m_dimensions.y * 4; } // stb always hands back rgba
 
 public:
 	IntVector2						m_dimensions;
 	int								m_numComponents = 0;
 	unsigned char*					m_imageData;
-	std::vector<Rgba>				m_texels;
+	std::vector<Rgba, TrackedAllocatorSTL<Rgba, MEMORY_TAG_RESOURCES>>	m_texels;
 };
\ No newline at end of file
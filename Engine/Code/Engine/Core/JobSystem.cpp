@@ -1,99 +1,741 @@
 #include "Engine/Core/JobSystem.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Core/IAllocator.hpp"
+#include "Engine/Core/Time.hpp"
+#include "Engine/Core/CommandDefinition.hpp"
+#include "Engine/Core/DevConsole.hpp"
+#include <algorithm>
+#include <intrin.h>
 
 std::unique_ptr<JobSystem> g_theJobSystem;
 
-int Job::s_globalID = 0;
+std::atomic<int> Job::s_globalID(0);
 
-JobSystem::JobSystem() {
+// the worker running on this thread, nullptr on non-worker threads
+static thread_local JobWorkerThread* s_currentWorker = nullptr;
+// where this thread records the jobs it runs, nullptr on threads that aren't traced
+static thread_local JobTimeline* s_currentTimeline = nullptr;
+
+static bool Command_JobTrace(Command& cmd) {
+	int frameCount = 10;
+	std::string filePath = "Log/job_trace.json";
+	if (!cmd.m_args.empty() && !cmd.GetNextArg<int>(frameCount)) {
+		return false;
+	}
+	if (!cmd.m_args.empty()) {
+		cmd.GetNextArg<std::string>(filePath);
+	}
+	if (!g_theJobSystem->WriteTrace(filePath, frameCount)) {
+		ConsolePrintf(Rgba::RED, "Failed to write job trace to %s", filePath.c_str());
+		return true;
+	}
+	ConsolePrintf("Job trace of the last %d frames written to %s", frameCount, filePath.c_str());
+	return true;
+}
+
+//------------------------------------------------------------------------
+// Pools
+namespace {
+// Lock free stack of free slot indices. The upper half of the head is a tag that changes
+// on every push/pop, so a thread holding a stale head can't swap it back in (ABA).
+class JobSlotFreeList {
+public:
+	explicit JobSlotFreeList(u32 count)
+		: m_next(new std::atomic<u32>[count]) {
+		for (u32 slotIdx = 0; slotIdx < count; ++slotIdx) {
+			m_next[slotIdx].store(slotIdx + 1 < count ? slotIdx + 1 : INVALID_JOB_SLOT, std::memory_order_relaxed);
+		}
+		m_head.store(count > 0 ? 0 : INVALID_JOB_SLOT, std::memory_order_release);
+	}
+
+	u32 Pop() {
+		u64 head = m_head.load(std::memory_order_acquire);
+		for (;;) {
+			u32 slotIdx = (u32)head;
+			if (slotIdx == INVALID_JOB_SLOT) {
+				return INVALID_JOB_SLOT;
+			}
+			u64 newHead = (((head >> 32) + 1) << 32) | m_next[slotIdx].load(std::memory_order_relaxed);
+			if (m_head.compare_exchange_weak(head, newHead, std::memory_order_acq_rel, std::memory_order_acquire)) {
+				return slotIdx;
+			}
+		}
+	}
+
+	void Push(u32 slotIdx) {
+		u64 head = m_head.load(std::memory_order_relaxed);
+		u64 newHead;
+		do {
+			m_next[slotIdx].store((u32)head, std::memory_order_relaxed);
+			newHead = (((head >> 32) + 1) << 32) | slotIdx;
+		} while (!m_head.compare_exchange_weak(head, newHead, std::memory_order_release, std::memory_order_relaxed));
+	}
+
+private:
+	std::atomic<u64>				m_head{ INVALID_JOB_SLOT };
+	Uptr<std::atomic<u32>[]>		m_next;
+};
+
+struct JobPools {
+	JobPools()
+		: m_freeStates(MAX_JOBS_IN_FLIGHT)
+		, m_freeJobBlocks(MAX_JOBS_IN_FLIGHT) {
+		m_jobBlocks = (u8*)AllocAligned(JOB_BLOCK_SIZE * MAX_JOBS_IN_FLIGHT, 64);
+	}
+
+	JobState				m_states[MAX_JOBS_IN_FLIGHT];
+	JobSlotFreeList			m_freeStates;
+	u8*						m_jobBlocks = nullptr;
+	JobSlotFreeList			m_freeJobBlocks;
+};
+
+// never freed, jobs can outlive the job system
+JobPools& GetJobPools() {
+	static JobPools* s_pools = new JobPools();
+	return *s_pools;
+}
+
+JobState& GetJobState(u32 stateIdx) {
+	return GetJobPools().m_states[stateIdx];
+}
+}
+
+//------------------------------------------------------------------------
+// Job
+Job::Job(u32 channels /*= JOB_CHANNEL_MASK_ALL*/, int jobType /*= -1*/)
+	: m_channels(channels), m_type(jobType) {
+	m_id = s_globalID++;
+	if (s_globalID < 0) {
+		s_globalID = 0;
+	}
+
+	m_stateIdx = GetJobPools().m_freeStates.Pop();
+	GUARANTEE_OR_DIE(m_stateIdx != INVALID_JOB_SLOT, "Job::Job - Too many jobs in flight, raise MAX_JOBS_IN_FLIGHT!");
+	JobState& state = GetJobState(m_stateIdx);
+	m_stateGeneration = state.m_generation.load(std::memory_order_relaxed);
+	state.m_pendingCount = 1;
+	state.m_unmetDependencies = 0;
+	state.m_parent = INVALID_JOB_SLOT;
+	state.m_channels.store(channels, std::memory_order_relaxed);
+	state.m_numDependents = 0;
+}
+
+Job::~Job() {
+	// never queued, nobody else knows about the state
+	if (!m_isSubmitted) {
+		++GetJobState(m_stateIdx).m_generation;
+		GetJobPools().m_freeStates.Push(m_stateIdx);
+	}
+}
+
+void* Job::operator new(size_t size) {
+	if (size <= JOB_BLOCK_SIZE) {
+		JobPools& pools = GetJobPools();
+		u32 blockIdx = pools.m_freeJobBlocks.Pop();
+		if (blockIdx != INVALID_JOB_SLOT) {
+			return pools.m_jobBlocks + (size_t)blockIdx * JOB_BLOCK_SIZE;
+		}
+	}
+	return ::operator new(size);
+}
+
+void Job::operator delete(void* ptr) {
+	JobPools& pools = GetJobPools();
+	u8* block = (u8*)ptr;
+	if (block >= pools.m_jobBlocks && block < pools.m_jobBlocks + JOB_BLOCK_SIZE * MAX_JOBS_IN_FLIGHT) {
+		pools.m_freeJobBlocks.Push((u32)((block - pools.m_jobBlocks) / JOB_BLOCK_SIZE));
+		return;
+	}
+	::operator delete(ptr);
+}
+
+bool JobHandle::IsFinished() const {
+	return m_stateIdx == INVALID_JOB_SLOT || GetJobState(m_stateIdx).m_generation.load() != m_generation;
+}
+
+//------------------------------------------------------------------------
+// JobDeque
+JobDeque::JobDeque()
+	: m_ring(64) {
+}
+
+std::unique_lock<std::mutex> JobDeque::Lock() {
+	std::unique_lock<std::mutex> lock(m_mutex, std::try_to_lock);
+	if (!lock.owns_lock()) {
+		if (s_currentTimeline) {
+			++s_currentTimeline->m_stats.m_numLockContentions;
+		}
+		lock.lock();
+	}
+	return lock;
+}
+
+void JobDeque::PushBack(Uptr<Job> job) {
+	std::unique_lock<std::mutex> lock = Lock();
+	if (m_count == (u32)m_ring.size()) {
+		Grow();
+	}
+	m_ring[(m_head + m_count) & (m_ring.size() - 1)] = std::move(job);
+	++m_count;
+	++m_size;
+}
+
+Uptr<Job> JobDeque::PopBack() {
+	if (IsEmpty()) {
+		return nullptr;
+	}
+	std::unique_lock<std::mutex> lock = Lock();
+	if (m_count == 0) {
+		return nullptr;
+	}
+	--m_count;
+	--m_size;
+	return std::move(m_ring[(m_head + m_count) & (m_ring.size() - 1)]);
+}
+
+Uptr<Job> JobDeque::PopFront() {
+	if (IsEmpty()) {
+		return nullptr;
+	}
+	std::unique_lock<std::mutex> lock = Lock();
+	if (m_count == 0) {
+		return nullptr;
+	}
+	Uptr<Job> job = std::move(m_ring[m_head]);
+	m_head = (m_head + 1) & (m_ring.size() - 1);
+	--m_count;
+	--m_size;
+	return job;
+}
+
+Uptr<Job> JobDeque::Steal(u32 channels) {
+	if (IsEmpty()) {
+		return nullptr;
+	}
+	std::unique_lock<std::mutex> lock = Lock();
+	size_t mask = m_ring.size() - 1;
+	for (u32 i = 0; i < m_count; ++i) {
+		if (JobSystem::IsChannelMatch(m_ring[(m_head + i) & mask]->m_channels, channels)) {
+			Uptr<Job> job = std::move(m_ring[(m_head + i) & mask]);
+			// close the gap by moving the older ones up
+			for (u32 j = i; j > 0; --j) {
+				m_ring[(m_head + j) & mask] = std::move(m_ring[(m_head + j - 1) & mask]);
+			}
+			m_head = (m_head + 1) & mask;
+			--m_count;
+			--m_size;
+			return job;
+		}
+	}
+	return nullptr;
+}
+
+void JobDeque::Grow() {
+	std::vector<Uptr<Job>> ring(m_ring.size() * 2);
+	for (u32 i = 0; i < m_count; ++i) {
+		ring[i] = std::move(m_ring[(m_head + i) & (m_ring.size() - 1)]);
+	}
+	m_ring.swap(ring);
+	m_head = 0;
+}
+
+//------------------------------------------------------------------------
+// JobSystem
+JobSystem::JobSystem()
+	: m_mainThreadId(std::this_thread::get_id())
+	, m_mainThreadTimeline("Main") {
+	s_currentTimeline = &m_mainThreadTimeline;
+	CommandDefinition::Register("job_trace", "[int frames, string file] Dump the last frames of jobs as a chrome://tracing json.", Command_JobTrace);
 }
 
 JobSystem::~JobSystem() {
-	for (auto& it = m_workerThreads.begin(); it != m_workerThreads.end(); ) {
-		it->m_isRunning = false;
-		it = m_workerThreads.erase(it);
+	std::vector<Uptr<JobWorkerThread>> workers;
+	{
+		std::unique_lock<std::shared_timed_mutex> lock(m_workerThreadsMutex);
+		workers.swap(m_workerThreads);
+	}
+	for (auto& worker : workers) {
+		StopWorkerThread(worker.get());
+	}
+	if (s_currentTimeline == &m_mainThreadTimeline) {
+		s_currentTimeline = nullptr;
 	}
 }
 
 void JobSystem::FinishAllCompletedJobs() {
-	std::lock_guard<std::mutex> lock(m_completedJobsMutex);
-	for (auto& it = m_completedJobs.begin(); it != m_completedJobs.end(); ) {
-		(*it)->JobCompleteCallback();
-		it = m_completedJobs.erase(it);
+	// only the jobs queued so far, anything they queue for the main thread waits for the next call
+	JobDeque& mainThreadJobs = m_channelJobs[JOB_CHANNEL_MAIN];
+	for (int jobCount = mainThreadJobs.GetSize(); jobCount > 0; --jobCount) {
+		Uptr<Job> job = mainThreadJobs.PopFront();
+		if (!job) {
+			break;
+		}
+		ExecuteJob(std::move(job));
+	}
+
+	// callbacks may queue new jobs, so run them outside of the lock
+	std::vector<Uptr<Job>> completedJobs;
+	completedJobs.swap(m_finishingJobs);
+	{
+		std::lock_guard<std::mutex> lock(m_completedJobsMutex);
+		completedJobs.swap(m_completedJobs);
+	}
+	for (auto& job : completedJobs) {
+		job->JobCompleteCallback();
 	}
+	completedJobs.clear();
+	completedJobs.swap(m_finishingJobs);
+}
+
+JobHandle JobSystem::QueueMainThreadJob(Uptr<Job> job) {
+	job->m_channels = JOB_CHANNEL_MASK_MAIN;
+	return QueueJob(std::move(job));
 }
 
-void JobSystem::CreateWorkerThread(const std::string& name, u32 channels /*= 0xFFFFFFFF*/) {
-	m_workerThreads.emplace_back(name, channels);
+void JobSystem::CreateWorkerThread(const std::string& name, u32 channels /*= JOB_CHANNEL_MASK_WORKERS*/, int coreIdx /*= -1*/, eThreadPriority priority /*= THREAD_PRIO_NORMAL*/) {
+	// the main channel belongs to the main thread
+	channels &= ~JOB_CHANNEL_MASK_MAIN;
+	GUARANTEE_OR_DIE(channels != 0, "JobSystem::CreateWorkerThread - Worker thread has no channel to serve!");
+	{
+		std::unique_lock<std::shared_timed_mutex> lock(m_workerThreadsMutex);
+		ThreadDesc_t threadDesc;
+		threadDesc.m_name = name;
+		threadDesc.m_coreIdx = coreIdx;
+		threadDesc.m_priority = priority;
+		m_workerThreads.push_back(std::make_unique<JobWorkerThread>(this, threadDesc, channels));
+		for (int channelIdx = 0; channelIdx < NUM_JOB_CHANNELS; ++channelIdx) {
+			if (channels & (1U << channelIdx)) {
+				++m_channelWorkerCounts[channelIdx];
+			}
+		}
+	}
+	// someone may be able to take the jobs nobody could take before
+	WakeWorkers();
 }
 
 void JobSystem::DestroyWorkerThread(const std::string& name) {
-	for (auto& it = m_workerThreads.begin(); it != m_workerThreads.end(); ) {
-		if (it->m_name == name) {
-			it->m_isRunning = false;
-			g_theThreadManager.Join(it->m_threadHandle);
-			it = m_workerThreads.erase(it);
+	std::vector<Uptr<JobWorkerThread>> workers;
+	{
+		std::unique_lock<std::shared_timed_mutex> lock(m_workerThreadsMutex);
+		for (auto it = m_workerThreads.begin(); it != m_workerThreads.end(); ) {
+			if ((*it)->m_name == name) {
+				for (int channelIdx = 0; channelIdx < NUM_JOB_CHANNELS; ++channelIdx) {
+					if ((*it)->m_channels & (1U << channelIdx)) {
+						--m_channelWorkerCounts[channelIdx];
+					}
+				}
+				workers.push_back(std::move(*it));
+				it = m_workerThreads.erase(it);
+			}
+			else {
+				++it;
+			}
 		}
-		else {
-			++it;
+	}
+
+	for (auto& worker : workers) {
+		StopWorkerThread(worker.get());
+		// hand the jobs it didn't get to over to the remaining workers
+		while (Uptr<Job> job = worker->m_localJobs.PopBack()) {
+			QueueReadyJob(std::move(job));
 		}
 	}
 }
 
-void JobSystem::QueueJob(Uptr<Job> job) {
-	std::lock_guard<std::mutex> lock(m_queuedJobsMutex);
-	m_queuedJobs.push_back(std::move(job));
+int JobSystem::GetWorkerThreadCount() const {
+	std::shared_lock<std::shared_timed_mutex> lock(m_workerThreadsMutex);
+	return (int)m_workerThreads.size();
+}
+
+void JobSystem::MarkFrame() {
+	m_frameStartHPCs[m_numFrames % JOB_TIMELINE_FRAME_COUNT] = GetPerformanceCounter();
+	++m_numFrames;
+}
+
+bool JobSystem::WriteTrace(const std::string& filePath, int frameCount) const {
+	frameCount = std::min(std::max(frameCount, 1), std::min(m_numFrames, JOB_TIMELINE_FRAME_COUNT));
+	std::vector<u64> frameStartHPCs;
+	for (int frameIdx = m_numFrames - frameCount; frameIdx < m_numFrames; ++frameIdx) {
+		frameStartHPCs.push_back(m_frameStartHPCs[frameIdx % JOB_TIMELINE_FRAME_COUNT]);
+	}
+
+	std::shared_lock<std::shared_timed_mutex> lock(m_workerThreadsMutex);
+	std::vector<const JobTimeline*> timelines;
+	timelines.push_back(&m_mainThreadTimeline);
+	for (auto& worker : m_workerThreads) {
+		timelines.push_back(&worker->m_timeline);
+	}
+	return WriteJobTimelinesToChromeTrace(filePath, timelines, frameStartHPCs);
+}
+
+JobHandle JobSystem::QueueJob(Uptr<Job> job) {
+	return SubmitJob(std::move(job), nullptr, {});
+}
+
+JobHandle JobSystem::QueueJob(Uptr<Job> job, const std::vector<JobHandle>& dependencies) {
+	return SubmitJob(std::move(job), nullptr, dependencies);
 }
 
-Job* JobSystem::ClaimJob(u32 channels) {
-	std::lock_guard<std::mutex> lock1(m_queuedJobsMutex);
-	std::lock_guard<std::mutex> lock2(m_runningJobsMutex);
-	for (auto& it = m_queuedJobs.begin(); it != m_queuedJobs.end(); ) {
-		if ((*it)->m_channels == channels) {
-			Job* j = (*it).get();
-			m_runningJobs.push_back(std::move(*it));
-			it = m_queuedJobs.erase(it);
-			return j;
+JobHandle JobSystem::QueueChildJob(const JobHandle& parent, Uptr<Job> job, const std::vector<JobHandle>& dependencies /*= {}*/) {
+	return SubmitJob(std::move(job), &parent, dependencies);
+}
+
+void JobSystem::WaitFor(const JobHandle& handle) {
+	if (handle.IsFinished()) {
+		return;
+	}
+
+	JobWorkerThread* worker = (s_currentWorker && s_currentWorker->m_owner == this) ? s_currentWorker : nullptr;
+	// other threads help with compute work while they wait. Main channel jobs wait for
+	// FinishAllCompletedJobs, running one here would nest it inside whatever is waiting,
+	// unless the main thread waits on one of them
+	u32 channels = JOB_CHANNEL_MASK_COMPUTE;
+	if (worker) {
+		channels = worker->m_channels;
+	}
+
+	// the slot may be reused once the job finished, only trust what was read before that
+	u32 jobChannels = GetJobState(handle.m_stateIdx).m_channels.load(std::memory_order_relaxed);
+	if (handle.IsFinished()) {
+		return;
+	}
+	u32 workerChannels = 0;
+	{
+		std::shared_lock<std::shared_timed_mutex> lock(m_workerThreadsMutex);
+		for (int channelIdx = 0; channelIdx < NUM_JOB_CHANNELS; ++channelIdx) {
+			if (m_channelWorkerCounts[channelIdx] > 0) {
+				workerChannels |= 1U << channelIdx;
+			}
+		}
+	}
+	// no worker can take it, so the main thread waiting on it has to, from the main channel too
+	if (!worker && IsMainThread() && !IsChannelMatch(jobChannels & ~JOB_CHANNEL_MASK_MAIN, workerChannels)) {
+		channels |= JOB_CHANNEL_MASK_MAIN;
+	}
+	// other threads can count on the main thread to get to its channel
+	u32 servedChannels = channels | workerChannels | (IsMainThread() ? 0 : JOB_CHANNEL_MASK_MAIN);
+	GUARANTEE_OR_DIE(IsChannelMatch(jobChannels, servedChannels), "JobSystem::WaitFor - No thread serves the job's channels, the wait would never end!");
+	++m_numWaiters;
+
+	int idleCount = 0;
+	while (!handle.IsFinished()) {
+		u64 wakeGeneration = m_wakeGeneration;
+		Uptr<Job> job = worker ? ClaimJob(worker) : StealJob(nullptr, channels);
+		if (job) {
+			ExecuteJob(std::move(job));
+			idleCount = 0;
+		}
+		else if (idleCount < JOB_WORKER_SPIN_COUNT) {
+			++idleCount;
+			_mm_pause();
 		}
 		else {
-			++it;
+			std::unique_lock<std::mutex> lock(m_sleepMutex);
+			++m_numSleepingWorkers;
+			m_wakeCondition.wait(lock, [&]() {
+				return m_wakeGeneration != wakeGeneration || handle.IsFinished();
+			});
+			--m_numSleepingWorkers;
+			idleCount = 0;
 		}
 	}
+	--m_numWaiters;
+}
+
+JobHandle JobSystem::SubmitJob(Uptr<Job> job, const JobHandle* parent, const std::vector<JobHandle>& dependencies) {
+	job->m_isSubmitted = true;
+	JobHandle handle = job->GetHandle();
+	JobState& state = GetJobState(handle.m_stateIdx);
+	state.m_channels.store(job->m_channels, std::memory_order_relaxed);
+
+	if (parent && parent->IsValid()) {
+		GUARANTEE_OR_DIE(!parent->IsFinished(), "JobSystem::QueueChildJob - Parent job has already finished!");
+		++GetJobState(parent->m_stateIdx).m_pendingCount;
+		state.m_parent = parent->m_stateIdx;
+	}
+
+	if (dependencies.empty()) {
+		QueueReadyJob(std::move(job));
+		return handle;
+	}
+
+	// park the job in its state, the last dependency to finish queues it.
+	// the extra count keeps it parked until every dependency is registered
+	state.m_job = std::move(job);
+	state.m_unmetDependencies = (int)dependencies.size() + 1;
+	for (auto& dependency : dependencies) {
+		bool isRegistered = false;
+		if (dependency.IsValid()) {
+			JobState& dependencyState = GetJobState(dependency.m_stateIdx);
+			std::lock_guard<std::mutex> lock(dependencyState.m_mutex);
+			// the generation only changes under the lock, so it can't finish in between
+			if (dependencyState.m_generation == dependency.m_generation) {
+				if (dependencyState.m_numDependents < JOB_INLINE_DEPENDENT_COUNT) {
+					dependencyState.m_dependents[dependencyState.m_numDependents++] = handle.m_stateIdx;
+				}
+				else {
+					dependencyState.m_moreDependents.push_back(handle.m_stateIdx);
+				}
+				isRegistered = true;
+			}
+		}
+		if (!isRegistered) {
+			--state.m_unmetDependencies;
+		}
+	}
+	if (--state.m_unmetDependencies == 0) {
+		std::unique_lock<std::mutex> lock(state.m_mutex);
+		Uptr<Job> readyJob = std::move(state.m_job);
+		lock.unlock();
+		QueueReadyJob(std::move(readyJob));
+	}
+	return handle;
+}
+
+void JobSystem::QueueReadyJob(Uptr<Job> job) {
+	job->m_queueHPC = GetPerformanceCounter();
+	job->m_isStolen = false;
+
+	// jobs queued from a worker stay on that worker, others steal them if it falls behind
+	if (s_currentWorker && s_currentWorker->m_owner == this && IsChannelMatch(job->m_channels, s_currentWorker->m_channels)) {
+		s_currentWorker->m_localJobs.PushBack(std::move(job));
+		WakeWorkers();
+		return;
+	}
+
+	int channelIdx = PickChannel(job->m_channels);
+	m_channelJobs[channelIdx].PushBack(std::move(job));
+	WakeWorkers();
+}
+
+int JobSystem::PickChannel(u32 jobChannels) const {
+	GUARANTEE_OR_DIE((jobChannels & ((1U << NUM_JOB_CHANNELS) - 1)) != 0, "JobSystem::PickChannel - Job isn't on any known channel!");
+
+	// first channel somebody serves, the main thread always serves its own
+	{
+		std::shared_lock<std::shared_timed_mutex> lock(m_workerThreadsMutex);
+		for (int channelIdx = 0; channelIdx < NUM_JOB_CHANNELS; ++channelIdx) {
+			if ((jobChannels & (1U << channelIdx)) && (channelIdx == JOB_CHANNEL_MAIN || m_channelWorkerCounts[channelIdx] > 0)) {
+				return channelIdx;
+			}
+		}
+	}
+
+	// nobody serves it yet, it waits on its first channel until a worker for it shows up
+	for (int channelIdx = 0; channelIdx < NUM_JOB_CHANNELS; ++channelIdx) {
+		if (jobChannels & (1U << channelIdx)) {
+			return channelIdx;
+		}
+	}
+	return JOB_CHANNEL_COMPUTE;
+}
+
+Uptr<Job> JobSystem::ClaimJob(JobWorkerThread* worker) {
+	Uptr<Job> job = worker->m_localJobs.PopBack();
+	if (job) {
+		return job;
+	}
+	return StealJob(worker, worker->m_channels);
+}
+
+Uptr<Job> JobSystem::StealJob(JobWorkerThread* thief, u32 channels) {
+	// the queues of our own channels first, anything in there is ours to take
+	for (int channelIdx = 0; channelIdx < NUM_JOB_CHANNELS; ++channelIdx) {
+		if (channels & (1U << channelIdx)) {
+			Uptr<Job> job = m_channelJobs[channelIdx].PopFront();
+			if (job) {
+				return job;
+			}
+		}
+	}
+
+	Uptr<Job> job;
+	std::shared_lock<std::shared_timed_mutex> lock(m_workerThreadsMutex);
+	size_t workerCount = m_workerThreads.size();
+	size_t startIdx = m_nextWorkerIdx.fetch_add(1, std::memory_order_relaxed);
+	for (size_t i = 0; i < workerCount; ++i) {
+		JobWorkerThread* victim = m_workerThreads[(startIdx + i) % workerCount].get();
+		if (victim == thief || !IsChannelMatch(victim->m_channels, channels)) {
+			continue;
+		}
+		job = victim->m_localJobs.Steal(channels);
+		if (job) {
+			job->m_isStolen = true;
+			if (s_currentTimeline) {
+				++s_currentTimeline->m_stats.m_numSteals;
+			}
+			return job;
+		}
+	}
+	if (s_currentTimeline) {
+		++s_currentTimeline->m_stats.m_numFailedSteals;
+	}
 	return nullptr;
 }
 
-void JobSystem::PostJob(int jobID) {
-	std::lock_guard<std::mutex> lock1(m_runningJobsMutex);
-	std::lock_guard<std::mutex> lock2(m_completedJobsMutex);
-	for (auto& it = m_runningJobs.begin(); it != m_runningJobs.end(); ) {
-		if ((*it)->m_id == jobID) {
-			m_completedJobs.push_back(std::move(*it));
-			it = m_runningJobs.erase(it);
-			return;
+void JobSystem::ExecuteJob(Uptr<Job> job) {
+	u32 stateIdx = job->m_stateIdx;
+	JobState& state = GetJobState(stateIdx);
+	JobTimeline* timeline = s_currentTimeline;
+	if (timeline) {
+		JobTraceEvent_t traceEvent;
+		traceEvent.m_jobId = job->m_id;
+		traceEvent.m_jobType = job->m_type;
+		traceEvent.m_isStolen = job->m_isStolen;
+		traceEvent.m_queueHPC = job->m_queueHPC;
+		traceEvent.m_startHPC = GetPerformanceCounter();
+		job->Execute();
+		traceEvent.m_endHPC = GetPerformanceCounter();
+
+		timeline->Record(traceEvent);
+		JobThreadStats_t& stats = timeline->m_stats;
+		++stats.m_numJobsExecuted;
+		stats.m_busyHPC += traceEvent.m_endHPC - traceEvent.m_startHPC;
+		if (traceEvent.m_queueHPC != 0 && traceEvent.m_startHPC > traceEvent.m_queueHPC) {
+			stats.m_queueWaitHPC += traceEvent.m_startHPC - traceEvent.m_queueHPC;
 		}
-		else {
-			++it;
+	}
+	else {
+		job->Execute();
+	}
+	{
+		// keep the job around until its children are done too
+		std::lock_guard<std::mutex> lock(state.m_mutex);
+		state.m_job = std::move(job);
+	}
+	ReleaseJobState(stateIdx);
+}
+
+void JobSystem::ReleaseJobState(u32 stateIdx) {
+	JobState& state = GetJobState(stateIdx);
+	if (--state.m_pendingCount > 0) {
+		return;
+	}
+
+	Uptr<Job> job;
+	u32 parentIdx;
+	u32 dependents[JOB_INLINE_DEPENDENT_COUNT];
+	int numDependents;
+	std::vector<u32> moreDependents;
+	{
+		std::lock_guard<std::mutex> lock(state.m_mutex);
+		job = std::move(state.m_job);
+		parentIdx = state.m_parent;
+		numDependents = state.m_numDependents;
+		for (int dependentIdx = 0; dependentIdx < numDependents; ++dependentIdx) {
+			dependents[dependentIdx] = state.m_dependents[dependentIdx];
 		}
+		moreDependents.swap(state.m_moreDependents);
+		// finished, handles and late dependents see a different generation from now on
+		++state.m_generation;
+	}
+
+	for (int dependentIdx = 0; dependentIdx < numDependents; ++dependentIdx) {
+		ReleaseDependent(dependents[dependentIdx]);
+	}
+	for (u32 dependent : moreDependents) {
+		ReleaseDependent(dependent);
+	}
+
+	// nobody else touches the slot anymore, hand the buffer back and recycle it
+	moreDependents.clear();
+	state.m_moreDependents.swap(moreDependents);
+	GetJobPools().m_freeStates.Push(stateIdx);
+
+	if (parentIdx != INVALID_JOB_SLOT) {
+		ReleaseJobState(parentIdx);
+	}
+
+	if (job && job->m_isCompleteCallbackEnabled) {
+		PostJob(std::move(job));
+	}
+	job.reset();
+	if (m_numWaiters > 0) {
+		WakeWorkers();
+	}
+}
+
+void JobSystem::ReleaseDependent(u32 stateIdx) {
+	JobState& state = GetJobState(stateIdx);
+	if (--state.m_unmetDependencies == 0) {
+		std::unique_lock<std::mutex> lock(state.m_mutex);
+		Uptr<Job> readyJob = std::move(state.m_job);
+		lock.unlock();
+		QueueReadyJob(std::move(readyJob));
 	}
 }
 
-JobWorkerThread::JobWorkerThread(const std::string& name, u32 channels) 
-	: m_name(name)
-	, m_channels(channels) {
-	m_threadHandle = g_theThreadManager.CreateThread(&JobWorkerThread::JobWorkerThreadEntryFunction, this);
-	g_theThreadManager.Detach(m_threadHandle);
+void JobSystem::PostJob(Uptr<Job> job) {
+	std::lock_guard<std::mutex> lock(m_completedJobsMutex);
+	m_completedJobs.push_back(std::move(job));
+}
+
+void JobSystem::StopWorkerThread(JobWorkerThread* worker) {
+	worker->m_isRunning = false;
+	{
+		std::lock_guard<std::mutex> lock(m_sleepMutex);
+		m_wakeCondition.notify_all();
+	}
+	g_theThreadManager.Join(worker->m_threadHandle);
+}
+
+void JobSystem::WakeWorkers() {
+	++m_wakeGeneration;
+	if (m_numSleepingWorkers > 0) {
+		// channels differ between workers, so wake them all and let the ones that can't help go back to sleep
+		std::lock_guard<std::mutex> lock(m_sleepMutex);
+		m_wakeCondition.notify_all();
+	}
+}
+
+void JobSystem::WaitForWork(JobWorkerThread* worker, u64 wakeGeneration) {
+	u64 sleepStartHPC = GetPerformanceCounter();
+	{
+		std::unique_lock<std::mutex> lock(m_sleepMutex);
+		++m_numSleepingWorkers;
+		m_wakeCondition.wait(lock, [&]() {
+			return m_wakeGeneration != wakeGeneration || !worker->IsRunning();
+		});
+		--m_numSleepingWorkers;
+	}
+	++worker->m_timeline.m_stats.m_numSleeps;
+	worker->m_timeline.m_stats.m_sleepHPC += GetPerformanceCounter() - sleepStartHPC;
+}
+
+//------------------------------------------------------------------------
+// JobWorkerThread
+JobWorkerThread::JobWorkerThread(JobSystem* owner, const ThreadDesc_t& threadDesc, u32 channels)
+	: m_owner(owner)
+	, m_name(threadDesc.m_name)
+	, m_channels(channels)
+	, m_timeline(threadDesc.m_name) {
+	m_threadHandle = g_theThreadManager.CreateThread(threadDesc, &JobWorkerThread::JobWorkerThreadEntryFunction, this);
 }
 
 JobWorkerThread::~JobWorkerThread() {
 }
 
 void JobWorkerThread::JobWorkerThreadEntryFunction() {
+	s_currentWorker = this;
+	s_currentTimeline = &m_timeline;
+	int idleCount = 0;
 	while (IsRunning()) {
-		if (g_theJobSystem) {
-			Job* claimedJob = g_theJobSystem->ClaimJob(m_channels);
-			if (claimedJob) {
-				claimedJob->Execute();
-				g_theJobSystem->PostJob(claimedJob->m_id);
-			}
+		// read the generation before looking, so a job queued in between wakes us right back up
+		u64 wakeGeneration = m_owner->m_wakeGeneration;
+		Uptr<Job> claimedJob = m_owner->ClaimJob(this);
+		if (claimedJob) {
+			m_owner->ExecuteJob(std::move(claimedJob));
+			idleCount = 0;
+		}
+		else if (idleCount < JOB_WORKER_SPIN_COUNT) {
+			++idleCount;
+			_mm_pause();
+		}
+		else {
+			m_owner->WaitForWork(this, wakeGeneration);
+			idleCount = 0;
 		}
 	}
+	s_currentWorker = nullptr;
+	s_currentTimeline = nullptr;
 }
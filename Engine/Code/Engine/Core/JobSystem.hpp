@@ -1,25 +1,43 @@
 #pragma once
 #include "Engine/Core/type.hpp"
 #include "Engine/Core/Thread.hpp"
+#include "Engine/Core/JobTimeline.hpp"
 #include <vector>
 #include <string>
+#include <mutex>
+#include <atomic>
+#include <shared_mutex>
+#include <condition_variable>
+#include <thread>
 
-class JobWorkerThread {
-	friend class JobSystem;
-public:
-	JobWorkerThread(const std::string& name, u32 channels);
-	~JobWorkerThread();
+// how many times an idle worker retries to find work before it parks
+constexpr int JOB_WORKER_SPIN_COUNT = 256;
 
-	bool IsRunning() const { return m_isRunning; }
-	void JobWorkerThreadEntryFunction();
+// Jobs and their states come from fixed pools, queuing a job doesn't touch the heap.
+// Every job holds a state slot from construction until it finished.
+constexpr int MAX_JOBS_IN_FLIGHT = 8192;
+constexpr size_t JOB_BLOCK_SIZE = 128;				// bigger jobs fall back to the heap
+constexpr int JOB_INLINE_DEPENDENT_COUNT = 4;
+constexpr u32 INVALID_JOB_SLOT = 0xFFFFFFFF;
 
-private:
-	std::string			m_name = "UNNAMED WORKER THREAD";
-	u32					m_channels = 0xFFFFFFFF;
-	threadHandle		m_threadHandle;
-	bool				m_isRunning = true;
+// Jobs and workers carry a mask of channels, a worker runs a job if they share at least one.
+// Each channel has its own queue, so e.g. IO workers never look at compute jobs.
+enum eJobChannel {
+	JOB_CHANNEL_COMPUTE = 0,
+	JOB_CHANNEL_IO,			// blocking disk work
+	JOB_CHANNEL_MAIN,		// run by the main thread in FinishAllCompletedJobs, never by a worker
+	NUM_JOB_CHANNELS
 };
 
+constexpr u32 JOB_CHANNEL_MASK_COMPUTE	= 1U << JOB_CHANNEL_COMPUTE;
+constexpr u32 JOB_CHANNEL_MASK_IO		= 1U << JOB_CHANNEL_IO;
+constexpr u32 JOB_CHANNEL_MASK_MAIN		= 1U << JOB_CHANNEL_MAIN;
+constexpr u32 JOB_CHANNEL_MASK_WORKERS	= JOB_CHANNEL_MASK_COMPUTE | JOB_CHANNEL_MASK_IO;
+constexpr u32 JOB_CHANNEL_MASK_ALL		= 0xFFFFFFFF;
+
+class JobSystem;
+class Job;
+
 // enum eJobStatus {
 // 	JOB_STATUS_QUEUED = 0,
 // 	JOB_STATUS_RUNNING,
@@ -27,26 +45,114 @@ private:
 // 	NUM_JOB_STATUS
 // };
 
+// Completion state of a job, a slot in a fixed pool.
+// The slot goes back to the pool when the job finished, the generation tells handles apart
+// from the ones of the next job in the same slot.
+struct JobState {
+	std::atomic<u32>	m_generation{ 0 };			// bumped when the job finished
+	std::atomic<int>	m_pendingCount{ 0 };		// the job itself + its unfinished children
+	std::atomic<int>	m_unmetDependencies{ 0 };	// jobs that have to finish before this one can run
+	u32					m_parent = INVALID_JOB_SLOT;
+	std::atomic<u32>	m_channels{ JOB_CHANNEL_MASK_ALL };	// of the job, for WaitFor to tell who can run it
+
+	std::mutex			m_mutex;
+	u32					m_dependents[JOB_INLINE_DEPENDENT_COUNT]; // "run after" jobs waiting on this one
+	int					m_numDependents = 0;
+	std::vector<u32>	m_moreDependents;			// the ones that don't fit inline, keeps its capacity
+	Uptr<Job>			m_job;						// parked here while waiting on dependencies or children
+};
+
+class JobHandle {
+	friend class JobSystem;
+	friend class Job;
+public:
+	JobHandle() = default;
+
+	bool IsValid() const { return m_stateIdx != INVALID_JOB_SLOT; }
+	bool IsFinished() const;
+
+private:
+	JobHandle(u32 stateIdx, u32 generation) : m_stateIdx(stateIdx), m_generation(generation) {}
+
+private:
+	u32 m_stateIdx = INVALID_JOB_SLOT;
+	u32 m_generation = 0;
+};
+
 class Job {
+	friend class JobSystem;
 public:
-	Job(u32 channels = 0xFFFFFFFF, int jobType = -1) 
-		: m_channels(channels), m_type(jobType) {
-		m_id = s_globalID++;
-		if (s_globalID < 0) {
-			s_globalID = 0;
-		}
-	}
-	virtual ~Job() = default;
+	Job(u32 channels = JOB_CHANNEL_MASK_ALL, int jobType = -1);
+	virtual ~Job();
 	virtual void Execute() = 0;
 	virtual void JobCompleteCallback() = 0;
 
+	// valid for the whole lifetime of the job, e.g. to queue child jobs from Execute()
+	JobHandle GetHandle() const { return JobHandle(m_stateIdx, m_stateGeneration); }
+
+	static void* operator new(size_t size);
+	static void operator delete(void* ptr);
+
 public:
 	int			m_id = -1;
 	int			m_type = -1;
-	u32			m_channels = 0xFFFFFFFF;
+	u32			m_channels = JOB_CHANNEL_MASK_ALL;
+	bool		m_isCompleteCallbackEnabled = true; // false skips the main thread round trip entirely
 /*	eJobStatus	m_status;*/
 
-	static int  s_globalID;
+	static std::atomic<int>  s_globalID;
+
+private:
+	u32			m_stateIdx = INVALID_JOB_SLOT;
+	u32			m_stateGeneration = 0;
+	bool		m_isSubmitted = false;	// from then on the job system releases the state
+	bool		m_isStolen = false;
+	u64			m_queueHPC = 0;			// when it became ready to run
+};
+
+// Per-worker job queue. The owner pushes and pops at the back (LIFO, cache warm),
+// other workers steal from the front (FIFO, oldest work first).
+// A ring buffer that only ever grows, so it stops allocating once it's warm.
+class JobDeque {
+public:
+	JobDeque();
+
+	void		PushBack(Uptr<Job> job);
+	Uptr<Job>	PopBack();
+	Uptr<Job>	PopFront();
+	Uptr<Job>	Steal(u32 channels);
+	bool		IsEmpty() const { return m_size.load(std::memory_order_relaxed) == 0; }
+	int			GetSize() const { return m_size.load(std::memory_order_relaxed); }
+
+private:
+	std::unique_lock<std::mutex> Lock();
+	void		Grow();
+
+private:
+	std::mutex				m_mutex;
+	std::vector<Uptr<Job>>	m_ring;			// power of 2 sized
+	u32						m_head = 0;
+	u32						m_count = 0;
+	std::atomic<int>		m_size{ 0 };	// m_count for peeking without the lock
+};
+
+class JobWorkerThread {
+	friend class JobSystem;
+public:
+	JobWorkerThread(JobSystem* owner, const ThreadDesc_t& threadDesc, u32 channels);
+	~JobWorkerThread();
+
+	bool IsRunning() const { return m_isRunning; }
+	void JobWorkerThreadEntryFunction();
+
+private:
+	JobSystem*			m_owner = nullptr;
+	std::string			m_name = "UNNAMED WORKER THREAD";
+	u32					m_channels = JOB_CHANNEL_MASK_WORKERS;
+	threadHandle		m_threadHandle;
+	std::atomic<bool>	m_isRunning{ true };
+	JobDeque			m_localJobs;
+	JobTimeline			m_timeline;
 };
 
 class JobSystem {
@@ -56,24 +162,61 @@ public:
 	~JobSystem();
 
 	void FinishAllCompletedJobs();
-	void QueueJob(Uptr<Job> job);
-	void CreateWorkerThread(const std::string& name, u32 channels = 0xFFFFFFFF);
+	JobHandle QueueJob(Uptr<Job> job);
+	JobHandle QueueJob(Uptr<Job> job, const std::vector<JobHandle>& dependencies); // runs after all dependencies finished
+	JobHandle QueueChildJob(const JobHandle& parent, Uptr<Job> job, const std::vector<JobHandle>& dependencies = {}); // parent isn't finished until its children are
+	// helps running other jobs while waiting. The main thread only runs main channel jobs here when it waits on one,
+	// waiting on a job nobody can run dies instead of hanging
+	void WaitFor(const JobHandle& handle);
+	JobHandle QueueMainThreadJob(Uptr<Job> job); // same as queuing it on JOB_CHANNEL_MASK_MAIN
+	bool IsMainThread() const { return std::this_thread::get_id() == m_mainThreadId; }
+	void CreateWorkerThread(const std::string& name, u32 channels = JOB_CHANNEL_MASK_WORKERS, int coreIdx = -1, eThreadPriority priority = THREAD_PRIO_NORMAL);
 	void DestroyWorkerThread(const std::string& name);
+	int GetWorkerThreadCount() const;
+	void MarkFrame(); // call once per frame on the main thread, for the trace
+	bool WriteTrace(const std::string& filePath, int frameCount) const; // chrome://tracing json of the last frameCount frames
+
+	static bool IsChannelMatch(u32 jobChannels, u32 workerChannels) { return (jobChannels & workerChannels) != 0; }
 
 private:
-	Job* ClaimJob(u32 channels);
-	void PostJob(int jobID);
+	JobHandle SubmitJob(Uptr<Job> job, const JobHandle* parent, const std::vector<JobHandle>& dependencies);
+	void QueueReadyJob(Uptr<Job> job);
+	int PickChannel(u32 jobChannels) const;
+	Uptr<Job> ClaimJob(JobWorkerThread* worker);
+	Uptr<Job> StealJob(JobWorkerThread* thief, u32 channels);
+	void ExecuteJob(Uptr<Job> job);
+	void ReleaseJobState(u32 stateIdx);
+	void ReleaseDependent(u32 stateIdx);
+	void PostJob(Uptr<Job> job);
+	void StopWorkerThread(JobWorkerThread* worker);
+	void WakeWorkers();
+	void WaitForWork(JobWorkerThread* worker, u64 wakeGeneration);
 
 private:
-	std::vector<JobWorkerThread>	m_workerThreads;
+	// guards the worker list itself, stealing only needs shared access
+	mutable std::shared_timed_mutex			m_workerThreadsMutex;
+	std::vector<Uptr<JobWorkerThread>>		m_workerThreads;
+	int										m_channelWorkerCounts[NUM_JOB_CHANNELS] = {};
+	std::atomic<u32>						m_nextWorkerIdx{ 0 };
+
+	// jobs queued from outside a matching worker, one queue per channel
+	JobDeque								m_channelJobs[NUM_JOB_CHANNELS];
 
-	std::mutex						m_queuedJobsMutex;
-	std::vector<Uptr<Job>>			m_queuedJobs;
+	std::mutex								m_completedJobsMutex;
+	std::vector<Uptr<Job>>					m_completedJobs;
+	std::vector<Uptr<Job>>					m_finishingJobs;	// swapped with m_completedJobs, both keep their capacity
 
-	std::mutex						m_runningJobsMutex;
-	std::vector<Uptr<Job>>			m_runningJobs;
+	// the job system is created on the main thread
+	std::thread::id							m_mainThreadId;
+	JobTimeline								m_mainThreadTimeline;
+	u64										m_frameStartHPCs[JOB_TIMELINE_FRAME_COUNT] = {};
+	int										m_numFrames = 0;
 
-	std::mutex						m_completedJobsMutex;
-	std::vector<Uptr<Job>>			m_completedJobs;
+	// idle workers park here until the generation changes
+	std::mutex								m_sleepMutex;
+	std::condition_variable					m_wakeCondition;
+	std::atomic<u64>						m_wakeGeneration{ 0 };
+	std::atomic<int>						m_numSleepingWorkers{ 0 };
+	std::atomic<int>						m_numWaiters{ 0 };	// threads in WaitFor
 };
 extern Uptr<JobSystem> g_theJobSystem;
\ No newline at end of file
@@ -0,0 +1,69 @@
+#include "Engine/Core/JobTimeline.hpp"
+#include "Engine/Core/ChromeTraceWriter.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Core/Time.hpp"
+#include <algorithm>
+
+JobTimeline::JobTimeline(const std::string& name)
+	: m_name(name)
+	, m_events(JOB_TIMELINE_EVENT_COUNT) {
+}
+
+void JobTimeline::Record(const JobTraceEvent_t& traceEvent) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_events[m_nextEventIdx] = traceEvent;
+	m_nextEventIdx = (m_nextEventIdx + 1) % JOB_TIMELINE_EVENT_COUNT;
+	m_numEvents = std::min(m_numEvents + 1, JOB_TIMELINE_EVENT_COUNT);
+}
+
+void JobTimeline::CopyEventsSince(u64 startHPC, std::vector<JobTraceEvent_t>& out) const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	int firstEventIdx = (m_nextEventIdx - m_numEvents + JOB_TIMELINE_EVENT_COUNT) % JOB_TIMELINE_EVENT_COUNT;
+	for (int i = 0; i < m_numEvents; ++i) {
+		const JobTraceEvent_t& traceEvent = m_events[(firstEventIdx + i) % JOB_TIMELINE_EVENT_COUNT];
+		if (traceEvent.m_endHPC >= startHPC) {
+			out.push_back(traceEvent);
+		}
+	}
+}
+
+//------------------------------------------------------------------------
+bool WriteJobTimelinesToChromeTrace(const std::string& filePath, const std::vector<const JobTimeline*>& timelines, const std::vector<u64>& frameStartHPCs) {
+	u64 originHPC = frameStartHPCs.empty() ? 0 : frameStartHPCs.front();
+	ChromeTraceWriter trace(filePath, "JobSystem", originHPC);
+	if (!trace.IsOpen()) {
+		return false;
+	}
+
+	for (u64 frameStartHPC : frameStartHPCs) {
+		trace.WriteFrame(frameStartHPC);
+	}
+
+	std::vector<JobTraceEvent_t> events;
+	for (size_t threadIdx = 0; threadIdx < timelines.size(); ++threadIdx) {
+		const JobTimeline* timeline = timelines[threadIdx];
+		const JobThreadStats_t& stats = timeline->m_stats;
+		trace.WriteThread((int)threadIdx, timeline->GetName());
+
+		// lifetime counters ride along on a counter event at the start of the window
+		trace.WriteEvent(Stringf("{\"name\":\"%s stats\",\"ph\":\"C\",\"pid\":1,\"tid\":%d,\"ts\":0,\"args\":{\"executed\":%llu,\"steals\":%llu,\"failed_steals\":%llu,\"lock_contentions\":%llu,\"sleeps\":%llu}}",
+			GetJsonEscapedString(timeline->GetName()).c_str(), (int)threadIdx,
+			(unsigned long long)stats.m_numJobsExecuted.load(), (unsigned long long)stats.m_numSteals.load(),
+			(unsigned long long)stats.m_numFailedSteals.load(), (unsigned long long)stats.m_numLockContentions.load(),
+			(unsigned long long)stats.m_numSleeps.load()));
+
+		events.clear();
+		timeline->CopyEventsSince(originHPC, events);
+		for (const JobTraceEvent_t& traceEvent : events) {
+			trace.WriteEvent(Stringf("{\"name\":\"Job %d\",\"cat\":\"job\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"type\":%d,\"wait_us\":%.3f,\"stolen\":%s}}",
+				traceEvent.m_jobId, (int)threadIdx,
+				trace.GetTimestamp(traceEvent.m_startHPC),
+				HPCToMicroseconds(traceEvent.m_endHPC, traceEvent.m_startHPC),
+				traceEvent.m_jobType,
+				HPCToMicroseconds(traceEvent.m_startHPC, traceEvent.m_queueHPC),
+				traceEvent.m_isStolen ? "true" : "false"));
+		}
+	}
+
+	return trace.Finish();
+}
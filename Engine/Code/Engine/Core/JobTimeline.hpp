@@ -0,0 +1,56 @@
+#pragma once
+#include "Engine/Core/type.hpp"
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// how many jobs each thread remembers for the trace
+constexpr int JOB_TIMELINE_EVENT_COUNT = 16384;
+// how many frame starts the job system remembers
+constexpr int JOB_TIMELINE_FRAME_COUNT = 300;
+
+struct JobTraceEvent_t {
+	u64		m_queueHPC = 0;		// when it became ready to run
+	u64		m_startHPC = 0;
+	u64		m_endHPC = 0;
+	int		m_jobId = -1;
+	int		m_jobType = -1;
+	bool	m_isStolen = false;	// taken from another worker's queue
+};
+
+// Counters of one thread running jobs, only that thread writes them
+struct JobThreadStats_t {
+	std::atomic<u64>	m_numJobsExecuted{ 0 };
+	std::atomic<u64>	m_numSteals{ 0 };
+	std::atomic<u64>	m_numFailedSteals{ 0 };		// looked at everyone's queue and found nothing
+	std::atomic<u64>	m_numLockContentions{ 0 };	// queue locks that were already taken
+	std::atomic<u64>	m_numSleeps{ 0 };
+	std::atomic<u64>	m_busyHPC{ 0 };
+	std::atomic<u64>	m_queueWaitHPC{ 0 };
+	std::atomic<u64>	m_sleepHPC{ 0 };
+};
+
+// The last JOB_TIMELINE_EVENT_COUNT jobs one thread ran, plus its counters.
+// The owning thread records, anyone can read a copy.
+class JobTimeline {
+public:
+	explicit JobTimeline(const std::string& name);
+
+	void Record(const JobTraceEvent_t& traceEvent);
+	void CopyEventsSince(u64 startHPC, std::vector<JobTraceEvent_t>& out) const;
+	const std::string& GetName() const { return m_name; }
+
+public:
+	JobThreadStats_t				m_stats;
+
+private:
+	std::string						m_name;
+	mutable std::mutex				m_mutex;
+	std::vector<JobTraceEvent_t>	m_events;
+	int								m_nextEventIdx = 0;
+	int								m_numEvents = 0;
+};
+
+// Writes the events since the first of frameStartHPCs in the Chrome trace format (chrome://tracing)
+bool WriteJobTimelinesToChromeTrace(const std::string& filePath, const std::vector<const JobTimeline*>& timelines, const std::vector<u64>& frameStartHPCs);
@@ -0,0 +1,162 @@
+#include "Engine/Core/LogRecord.hpp"
+#include <cstdio>
+#include <cstring>
+
+constexpr size_t LOG_RECORD_SPEC_LENGTH = 32;
+constexpr size_t LOG_RECORD_FIELD_LENGTH = 512;
+
+static s64 GetArgAsInt(const LogRecord_t& record, u8 argIdx) {
+	if (argIdx >= record.m_numArgs) {
+		return 0;
+	}
+	const LogArg_t& arg = record.m_args[argIdx];
+	switch (arg.m_type) {
+	case LOG_ARG_INT:		return arg.m_int;
+	case LOG_ARG_UINT:		return (s64)arg.m_uint;
+	case LOG_ARG_DOUBLE:	return (s64)arg.m_double;
+	case LOG_ARG_POINTER:	return (s64)(uintptr_t)arg.m_pointer;
+	default:				return 0;
+	}
+}
+
+static double GetArgAsDouble(const LogRecord_t& record, u8 argIdx) {
+	if (argIdx >= record.m_numArgs) {
+		return 0.0;
+	}
+	const LogArg_t& arg = record.m_args[argIdx];
+	switch (arg.m_type) {
+	case LOG_ARG_INT:		return (double)arg.m_int;
+	case LOG_ARG_UINT:		return (double)arg.m_uint;
+	case LOG_ARG_DOUBLE:	return arg.m_double;
+	default:				return 0.0;
+	}
+}
+
+static const char* GetArgAsString(const LogRecord_t& record, u8 argIdx) {
+	if (argIdx >= record.m_numArgs || record.m_args[argIdx].m_type != LOG_ARG_STRING) {
+		return "(null)";
+	}
+	return record.m_strings + record.m_args[argIdx].m_stringOffset;
+}
+
+static const void* GetArgAsPointer(const LogRecord_t& record, u8 argIdx) {
+	if (argIdx >= record.m_numArgs || record.m_args[argIdx].m_type != LOG_ARG_POINTER) {
+		return nullptr;
+	}
+	return record.m_args[argIdx].m_pointer;
+}
+
+void CaptureLogArg(LogRecord_t& record, const char* str) {
+	LogArg_t& arg = record.m_args[record.m_numArgs++];
+	arg.m_type = LOG_ARG_STRING;
+	if (str == nullptr) {
+		str = "(null)";
+	}
+
+	// always room for the terminator, the last string may end up empty
+	u16 offset = record.m_numStringBytes < LOG_RECORD_STRING_BYTES ? record.m_numStringBytes : LOG_RECORD_STRING_BYTES - 1;
+	size_t length = strlen(str);
+	size_t room = LOG_RECORD_STRING_BYTES - offset - 1;
+	if (length > room) {
+		length = room;
+	}
+	memcpy(record.m_strings + offset, str, length);
+	record.m_strings[offset + length] = '\0';
+	arg.m_stringOffset = offset;
+	record.m_numStringBytes = (u16)(offset + length + 1);
+}
+
+std::string FormatLogRecord(const LogRecord_t& record) {
+	std::string text;
+	char spec[LOG_RECORD_SPEC_LENGTH];
+	char field[LOG_RECORD_FIELD_LENGTH];
+	u8 argIdx = 0;
+
+	const char* cursor = record.m_format;
+	while (*cursor != '\0') {
+		if (*cursor != '%') {
+			text.push_back(*cursor++);
+			continue;
+		}
+		if (cursor[1] == '%') {
+			text.push_back('%');
+			cursor += 2;
+			continue;
+		}
+
+		// keep the flags, width and precision
+		size_t specLength = 0;
+		spec[specLength++] = *cursor++;
+		while (*cursor != '\0' && strchr("-+ #0123456789.*", *cursor)) {
+			// room left for a width from the args and the conversion
+			bool hasRoom = specLength < LOG_RECORD_SPEC_LENGTH - 16;
+			if (*cursor == '*') {
+				int value = (int)GetArgAsInt(record, argIdx++);
+				if (hasRoom) {
+					specLength += snprintf(spec + specLength, LOG_RECORD_SPEC_LENGTH - specLength, "%d", value);
+				}
+			}
+			else if (hasRoom) {
+				spec[specLength++] = *cursor;
+			}
+			++cursor;
+		}
+		// drop the length modifier, the captured type is what counts (I64 and friends included)
+		while (*cursor != '\0' && strchr("hljztLI0123456789", *cursor)) {
+			++cursor;
+		}
+
+		char conversion = *cursor;
+		if (conversion == '\0') {
+			break;
+		}
+		++cursor;
+
+		int fieldLength = 0;
+		switch (conversion) {
+		case 'd': case 'i':
+			spec[specLength++] = 'l';
+			spec[specLength++] = 'l';
+			spec[specLength++] = conversion;
+			spec[specLength] = '\0';
+			fieldLength = snprintf(field, LOG_RECORD_FIELD_LENGTH, spec, (long long)GetArgAsInt(record, argIdx++));
+			break;
+		case 'u': case 'o': case 'x': case 'X':
+			spec[specLength++] = 'l';
+			spec[specLength++] = 'l';
+			spec[specLength++] = conversion;
+			spec[specLength] = '\0';
+			fieldLength = snprintf(field, LOG_RECORD_FIELD_LENGTH, spec, (unsigned long long)GetArgAsInt(record, argIdx++));
+			break;
+		case 'c':
+			spec[specLength++] = conversion;
+			spec[specLength] = '\0';
+			fieldLength = snprintf(field, LOG_RECORD_FIELD_LENGTH, spec, (int)GetArgAsInt(record, argIdx++));
+			break;
+		case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'a': case 'A':
+			spec[specLength++] = conversion;
+			spec[specLength] = '\0';
+			fieldLength = snprintf(field, LOG_RECORD_FIELD_LENGTH, spec, GetArgAsDouble(record, argIdx++));
+			break;
+		case 's':
+			spec[specLength++] = conversion;
+			spec[specLength] = '\0';
+			fieldLength = snprintf(field, LOG_RECORD_FIELD_LENGTH, spec, GetArgAsString(record, argIdx++));
+			break;
+		case 'p':
+			spec[specLength++] = conversion;
+			spec[specLength] = '\0';
+			fieldLength = snprintf(field, LOG_RECORD_FIELD_LENGTH, spec, GetArgAsPointer(record, argIdx++));
+			break;
+		default:
+			// %n and anything unknown, eat the argument and print nothing
+			++argIdx;
+			break;
+		}
+
+		if (fieldLength > 0) {
+			text.append(field, (size_t)fieldLength < LOG_RECORD_FIELD_LENGTH ? (size_t)fieldLength : LOG_RECORD_FIELD_LENGTH - 1);
+		}
+	}
+	return text;
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include "Engine/Core/type.hpp"
+#include <string>
+#include <type_traits>
+
+constexpr u8 LOG_RECORD_MAX_ARGS = 8;
+// string arguments are copied in here, longer ones get cut
+constexpr u16 LOG_RECORD_STRING_BYTES = 192;
+
+enum eLogArgType : u8 {
+	LOG_ARG_INT,
+	LOG_ARG_UINT,
+	LOG_ARG_DOUBLE,
+	LOG_ARG_POINTER,
+	LOG_ARG_STRING
+};
+
+struct LogArg_t {
+	eLogArgType m_type;
+	union {
+		s64			m_int;
+		u64			m_uint;
+		double		m_double;
+		const void*	m_pointer;
+		u16			m_stringOffset;	// into LogRecord_t::m_strings
+	};
+};
+
+// A log call captured as is, formatted later on the logger thread.
+// The tag and the format are kept as pointers, they have to be string literals.
+struct LogRecord_t {
+	const char*	m_tag;
+	const char*	m_format;
+	u64			m_hpc;
+	u8			m_numArgs;
+	u16			m_numStringBytes;
+	LogArg_t	m_args[LOG_RECORD_MAX_ARGS];
+	char		m_strings[LOG_RECORD_STRING_BYTES];
+};
+
+// runs the printf format against the captured arguments
+std::string FormatLogRecord(const LogRecord_t& record);
+
+//------------------------------------------------------------------------
+void CaptureLogArg(LogRecord_t& record, const char* str);
+inline void CaptureLogArg(LogRecord_t& record, char* str) { CaptureLogArg(record, (const char*)str); }
+inline void CaptureLogArg(LogRecord_t& record, const std::string& str) { CaptureLogArg(record, str.c_str()); }
+
+template <typename T>
+typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value>::type CaptureLogArg(LogRecord_t& record, T value) {
+	LogArg_t& arg = record.m_args[record.m_numArgs++];
+	if (std::is_signed<T>::value || std::is_enum<T>::value) {
+		arg.m_type = LOG_ARG_INT;
+		arg.m_int = (s64)value;
+	}
+	else {
+		arg.m_type = LOG_ARG_UINT;
+		arg.m_uint = (u64)value;
+	}
+}
+
+template <typename T>
+typename std::enable_if<std::is_floating_point<T>::value>::type CaptureLogArg(LogRecord_t& record, T value) {
+	LogArg_t& arg = record.m_args[record.m_numArgs++];
+	arg.m_type = LOG_ARG_DOUBLE;
+	arg.m_double = (double)value;
+}
+
+template <typename T>
+void CaptureLogArg(LogRecord_t& record, const T* ptr) {
+	LogArg_t& arg = record.m_args[record.m_numArgs++];
+	arg.m_type = LOG_ARG_POINTER;
+	arg.m_pointer = ptr;
+}
+
+inline void CaptureLogArgs(LogRecord_t&) {}
+
+template <typename T, typename... Rest>
+void CaptureLogArgs(LogRecord_t& record, const T& arg, const Rest&... rest) {
+	CaptureLogArg(record, arg);
+	CaptureLogArgs(record, rest...);
+}
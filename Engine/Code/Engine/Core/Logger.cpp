@@ -3,13 +3,47 @@
 #include "Engine/Core/StringUtils.hpp"
 #include "Engine/Core/Time.hpp"
 #include "Engine/Core/EngineCommon.hpp"
-#include "Engine/Core/FileSystem.hpp"
 #include "Engine/Core/DevConsole.hpp"
 #include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Core/TrackingAllocator.hpp"
 #include <algorithm>
 
 constexpr int LOGGER_STRINGF_LENGTH = 4096;
 
+static std::atomic<u32> s_numLoggersCreated{ 0 };
+
+static size_t GetLogSize(const Log_t& data) {
+	return data.m_tag.size() + data.m_text.size();
+}
+
+static constexpr size_t GetThreadLogRingSize() {
+	return sizeof(ThreadLogRing_t) + LOGGER_THREAD_RING_CAPACITY * sizeof(LogRecord_t);
+}
+
+static void ReleaseThreadLogRing(ThreadLogRing_t* ring) {
+	if (--ring->m_refCount == 0) {
+		delete ring;
+		TrackMemoryFree(MEMORY_TAG_LOGGER, GetThreadLogRingSize());
+	}
+}
+
+// lets go of the thread's ring when the thread exits, the logger still drains what's left
+struct ThreadLogRingOwner {
+	~ThreadLogRingOwner() { Release(); }
+
+	void Release() {
+		if (m_ring) {
+			m_ring->m_isThreadAlive = false;
+			ReleaseThreadLogRing(m_ring);
+			m_ring = nullptr;
+		}
+	}
+
+	ThreadLogRing_t* m_ring = nullptr;
+};
+
+static thread_local ThreadLogRingOwner s_threadLogRing;
+
 static bool Command_LogFlushTest(Command& cmd) {
 	if (!cmd.m_args.empty()) {
 		return false;
@@ -65,23 +99,35 @@ static bool Command_LogHideTag(Command& cmd) {
 	}
 }
 
-Logger::Logger()  {
- 	//Hook(WriteToFile_cb);
+static bool Command_LogCompress(Command& cmd) {
+	int isCompressing = 1;
+	if (!cmd.m_args.empty() && !cmd.GetNextArg<int>(isCompressing)) {
+		return false;
+	}
+	if (!g_theLogger->m_logFile) {
+		ConsolePrintf(Rgba::RED, "No log file is open.");
+		return true;
+	}
+	g_theLogger->m_logFile->SetCompressSegments(isCompressing != 0);
+	ConsolePrintf("Rotated log segments are %s.", isCompressing ? "compressed" : "kept as text");
+	return true;
+}
+
+Logger::Logger()
+	: m_id(++s_numLoggersCreated) {
+ 	Hook(WriteToFile_cb);
  	Hook(WriteToConsole_cb);
  	//Hook(WriteToOutputWindow_cb);
 
 	if (!m_hooks.empty()) {
 		if(std::find(m_hooks.begin(), m_hooks.end(), WriteToFile_cb) != m_hooks.end()){
-			m_logFileStream.open(m_filePath + ".txt", std::ios::out | std::ios::app);
-			std::string filepathTimestamp = m_filePath + '_' + GetTimestamp() + ".txt";
-			m_currentLogFileStream.open(filepathTimestamp, std::ios::out);
-			if (m_logFileStream.is_open() == false) {
-				::CreateDirectoryA("Log", NULL);
-				m_logFileStream.open(m_filePath + ".txt", std::ios::out | std::ios::app);
-				m_currentLogFileStream.open(m_filePath + '_' + GetTimestamp() + ".txt", std::ios::out);
-			}
+			::CreateDirectoryA("Log", NULL);
+			m_logFile = std::make_unique<MappedLogFile>(m_filePath);
 		}
-		m_thread = g_theThreadManager.CreateThread(&Logger::LoggerThreadWorker, this);
+		ThreadDesc_t threadDesc;
+		threadDesc.m_name = "Logger";
+		threadDesc.m_priority = THREAD_PRIO_LOW;
+		m_thread = g_theThreadManager.CreateThread(threadDesc, &Logger::LoggerThreadWorker, this);
 	}
 
 	CommandDefinition::Register("log_flush_test", "[N/A] Log flush test.", Command_LogFlushTest);
@@ -89,34 +135,146 @@ Logger::Logger()  {
 	CommandDefinition::Register("log_hide_all", "[N/A] Hide all logs.", Command_LogHideAll);
 	CommandDefinition::Register("log_show_tag", "[string] Show logs with tag.", Command_LogShowTag);
 	CommandDefinition::Register("log_hide_tag", "[string] Hide logs with tag.", Command_LogHideTag);
+	CommandDefinition::Register("log_compress", "[0/1] Compress rotated log segments.", Command_LogCompress);
 }
 
 Logger::~Logger() {
 	m_isRunning = false;
 	if (!m_hooks.empty()) {
 		g_theThreadManager.Join(m_thread);
+
+		// logs that got in after the logger thread's last look
+		std::vector<Log_t> batch;
+		CollectLogs(batch);
+		DispatchLogs(batch);
+		u32 numDroppedLogs = m_numDroppedLogs.exchange(0);
+		if (numDroppedLogs > 0 && m_logFile) {
+			m_logFile->WriteLine(Stringf("%s [warning]: %u logs dropped, they came in after the logger stopped.", GetTimestamp().c_str(), numDroppedLogs));
+		}
 	}
-	m_currentLogFileStream.close();
-	m_logFileStream.close();
+	// threads still holding a ring let go of it on their next fast log or when they exit
+	for (ThreadLogRing_t* ring : m_threadRings) {
+		ReleaseThreadLogRing(ring);
+	}
+	m_threadRings.clear();
+	m_logFile.reset();
 }
 
 void Logger::LoggerThreadWorker() {
+	std::vector<Log_t> batch;
+	batch.reserve(LOGGER_BATCH_SIZE);
 	while (m_isRunning) {
-		Log_t data;
-		while (m_queue.Dequeue(data)) {
-			// do something with the data
-			m_hookLock.Enter();
-			for (auto& hook : m_hooks) {
-				hook(data);
-			}
-			m_hookLock.Exit();
+		CollectLogs(batch);
+		while (!batch.empty()) {
+			DispatchLogs(batch);
+			batch.clear();
+			CollectLogs(batch);
 		}
 		if (m_isFlushing) {
-			m_logFileStream.flush();
+			if (m_logFile) {
+				m_logFile->Flush();
+			}
 			m_isFlushing = false;
 		}
 		std::this_thread::sleep_for(std::chrono::milliseconds(10));
 	}
+
+	// whatever came in while shutting down
+	CollectLogs(batch);
+	while (!batch.empty()) {
+		DispatchLogs(batch);
+		batch.clear();
+		CollectLogs(batch);
+	}
+}
+
+void Logger::CollectLogs(std::vector<Log_t>& batch) {
+	size_t numQueuedLogs = m_queue.DequeueBatch(batch, LOGGER_BATCH_SIZE);
+	for (size_t logIdx = 0; logIdx < numQueuedLogs; ++logIdx) {
+		TrackMemoryFree(MEMORY_TAG_LOGGER, GetLogSize(batch[logIdx]));
+	}
+	CollectThreadRings(batch);
+
+	// every thread has its own ring, put their logs back in time order
+	std::stable_sort(batch.begin(), batch.end(), [](const Log_t& a, const Log_t& b) { return a.m_hpc < b.m_hpc; });
+}
+
+void Logger::CollectThreadRings(std::vector<Log_t>& batch) {
+	std::vector<ThreadLogRing_t*> rings;
+	{
+		SpinLockScope scope(m_threadRingsLock);
+		rings = m_threadRings;
+	}
+
+	std::vector<ThreadLogRing_t*> deadRings;
+	for (ThreadLogRing_t* ring : rings) {
+		// read before draining, all a dead thread logged is in the ring by then
+		bool isThreadAlive = ring->m_isThreadAlive;
+
+		// the deferred part, formatting happens here instead of on the logging thread
+		m_records.clear();
+		ring->m_records.DequeueBatch(m_records, LOGGER_BATCH_SIZE);
+		for (const LogRecord_t& record : m_records) {
+			if (LogTagFilter(record.m_tag)) {
+				continue;
+			}
+			Log_t data;
+			data.m_tag = record.m_tag;
+			data.m_text = FormatLogRecord(record);
+			data.m_hpc = record.m_hpc;
+			batch.push_back(std::move(data));
+		}
+
+		u32 numDropped = ring->m_numDropped.exchange(0);
+		if (numDropped > 0) {
+			Log_t data;
+			data.m_tag = "warning";
+			data.m_text = Stringf("%u fast logs dropped, a thread's log ring was full.", numDropped);
+			data.m_hpc = GetPerformanceCounter();
+			batch.push_back(std::move(data));
+		}
+
+		if (!isThreadAlive && ring->m_records.GetApproxSize() == 0) {
+			deadRings.push_back(ring);
+		}
+	}
+
+	if (!deadRings.empty()) {
+		SpinLockScope scope(m_threadRingsLock);
+		for (ThreadLogRing_t* ring : deadRings) {
+			m_threadRings.erase(std::find(m_threadRings.begin(), m_threadRings.end(), ring));
+			ReleaseThreadLogRing(ring);
+		}
+	}
+}
+
+void Logger::DispatchLogs(const std::vector<Log_t>& batch) {
+	m_hookLock.Enter();
+	for (const Log_t& data : batch) {
+		for (auto& hook : m_hooks) {
+			hook(data);
+		}
+	}
+	m_hookLock.Exit();
+}
+
+ThreadLogRing_t* Logger::GetThreadLogRing() {
+	ThreadLogRing_t* ring = s_threadLogRing.m_ring;
+	if (ring && ring->m_loggerId == m_id) {
+		return ring;
+	}
+
+	// first fast log on this thread, or the ring was made for an older logger
+	s_threadLogRing.Release();
+	ring = new ThreadLogRing_t();
+	ring->m_loggerId = m_id;
+	TrackMemoryAlloc(MEMORY_TAG_LOGGER, GetThreadLogRingSize());
+	{
+		SpinLockScope scope(m_threadRingsLock);
+		m_threadRings.push_back(ring);
+	}
+	s_threadLogRing.m_ring = ring;
+	return ring;
 }
 
 void Logger::Hook(log_cb cb) {
@@ -131,19 +289,34 @@ void Logger::UnHook(log_cb cb) {
 }
 
 void LogTaggedPrintv(const std::string& tag, const char* format, va_list args) {
-	if (!g_theLogger) {
+	// without hooks there is no logger thread to drain the queue
+	if (!g_theLogger || g_theLogger->m_hooks.empty()) {
+		return;
+	}
+	if (!g_theLogger->IsRunning()) {
+		++g_theLogger->m_numDroppedLogs;
 		return;
 	}
 	char textLiteral[LOGGER_STRINGF_LENGTH];
 	vsnprintf_s(textLiteral, LOGGER_STRINGF_LENGTH, _TRUNCATE, format, args);
 	textLiteral[LOGGER_STRINGF_LENGTH - 1] = '\0'; // In case vsnprintf overran (doesn't auto-terminate)
 
-	std::string text(textLiteral);
-
 	Log_t data;
 	data.m_tag = tag;
-	data.m_text = text;
-	g_theLogger->m_queue.Enqueue(std::move(data));
+	data.m_text = textLiteral;
+	data.m_hpc = GetPerformanceCounter();
+	// counts text waiting for the logger thread
+	TrackMemoryAlloc(MEMORY_TAG_LOGGER, GetLogSize(data));
+	// full means the logger thread is behind, wait for it rather than lose the log,
+	// unless it's shutting down and won't come back for it
+	while (!g_theLogger->m_queue.TryEnqueue(std::move(data))) {
+		if (!g_theLogger->IsRunning()) {
+			TrackMemoryFree(MEMORY_TAG_LOGGER, GetLogSize(data));
+			++g_theLogger->m_numDroppedLogs;
+			return;
+		}
+		std::this_thread::yield();
+	}
 }
 
 void LogTaggedPrintf(const std::string& tag, const char* format, ...) {
@@ -174,9 +347,28 @@ void LogErrorf(const char* format, ...) {
 	va_end(variableArgumentList);
 }
 
+void SubmitLogRecord(LogRecord_t& record) {
+	// without hooks there is no logger thread to drain the rings
+	if (!g_theLogger || g_theLogger->m_hooks.empty()) {
+		return;
+	}
+	record.m_hpc = GetPerformanceCounter();
+	ThreadLogRing_t* ring = g_theLogger->GetThreadLogRing();
+	// never wait on a hot path
+	if (!ring->m_records.TryEnqueue(record)) {
+		++ring->m_numDropped;
+	}
+}
+
 void LogFlush() {
+	if (!g_theLogger || g_theLogger->m_hooks.empty()) {
+		return;
+	}
 	g_theLogger->m_isFlushing = true;
-	while (g_theLogger->m_isFlushing == true) {}
+	// a stopped logger thread never clears the flag, the shutdown writes everything out anyway
+	while (g_theLogger->m_isFlushing && g_theLogger->IsRunning()) {
+		std::this_thread::yield();
+	}
 }
 
 void LogShowAll() {
@@ -209,12 +401,12 @@ void LogHideTag(const std::string& tag) {
 
 bool LogTagFilter(const std::string& tag) {
 	if (g_theLogger->m_isFilterWhiteList) {
-		if (!g_theLogger->m_filter.Find(tag)) {
+		if (!g_theLogger->m_filter.Contains(tag)) {
 			return true;
 		}
 	}
 	else {
-		if (g_theLogger->m_filter.Find(tag)) {
+		if (g_theLogger->m_filter.Contains(tag)) {
 			return true;
 		}
 	}
@@ -226,10 +418,9 @@ void WriteToFile_cb(const Log_t& data) {
 		return;
 	}
 
-	FileSystem::WriteToFile(g_theLogger->m_logFileStream, 
-		Stringf("%s [%s]: %s", GetTimestamp().c_str(), data.m_tag.c_str(), data.m_text.c_str()));
-	FileSystem::WriteToFile(g_theLogger->m_currentLogFileStream,
-		Stringf("%s [%s]: %s", GetTimestamp().c_str(), data.m_tag.c_str(), data.m_text.c_str()));
+	if (g_theLogger->m_logFile) {
+		g_theLogger->m_logFile->WriteLine(Stringf("%s [%s]: %s", GetTimestamp(data.m_hpc).c_str(), data.m_tag.c_str(), data.m_text.c_str()));
+	}
 }
 
 void WriteToConsole_cb(const Log_t& data) {
@@ -245,7 +436,7 @@ void WriteToConsole_cb(const Log_t& data) {
 	else if (tag == "warning") {
 		textColor = Rgba::YELLOW;
 	}
-	ConsolePrintf(textColor, "%s [%s]: %s", GetTimestamp().c_str(), data.m_tag.c_str(), data.m_text.c_str());
+	ConsolePrintf(textColor, "%s [%s]: %s", GetTimestamp(data.m_hpc).c_str(), data.m_tag.c_str(), data.m_text.c_str());
 }
 
 void WriteToOutputWindow_cb(const Log_t& data) {
@@ -253,6 +444,6 @@ void WriteToOutputWindow_cb(const Log_t& data) {
 		return;
 	}
 	if (IsDebuggerAvailable()) {
-		OutputDebugStringA(Stringf("%s [%s]: %s", GetTimestamp().c_str(), data.m_tag.c_str(), data.m_text.c_str()).c_str());
+		OutputDebugStringA(Stringf("%s [%s]: %s", GetTimestamp(data.m_hpc).c_str(), data.m_tag.c_str(), data.m_text.c_str()).c_str());
 	}
 }
\ No newline at end of file
@@ -1,13 +1,33 @@
 #pragma once
 #include "Engine/Core/type.hpp"
 #include "Engine/Core/ThreadSafeContainer.hpp"
-#include <fstream>
+#include "Engine/Core/RingQueue.hpp"
+#include "Engine/Core/LogRecord.hpp"
+#include "Engine/Core/MappedLogFile.hpp"
+#include <atomic>
 #include <string>
 #include <vector>
 
+// logs waiting for the logger thread, producers wait for room past that
+constexpr size_t LOGGER_QUEUE_CAPACITY = 4096;
+// logs the logger thread takes off the queue at once
+constexpr size_t LOGGER_BATCH_SIZE = 256;
+// records each thread can have waiting in its own ring, past that fast logs are dropped
+constexpr size_t LOGGER_THREAD_RING_CAPACITY = 1024;
+
 struct Log_t {
 	std::string m_tag;
 	std::string m_text;
+	u64			m_hpc = 0;	// when it was logged
+};
+
+// One thread's fast logs. Shared by the thread and the logger, the last one to let go deletes it.
+struct ThreadLogRing_t {
+	SPSCRingQueue<LogRecord_t>	m_records{ LOGGER_THREAD_RING_CAPACITY };
+	std::atomic<u32>			m_numDropped{ 0 };
+	std::atomic<bool>			m_isThreadAlive{ true };
+	std::atomic<int>			m_refCount{ 2 };
+	u32							m_loggerId = 0;	// rings from an older logger are dropped
 };
 
 typedef void(*log_cb)(const Log_t& data);
@@ -23,21 +43,36 @@ public:
 	void Hook(log_cb cb);
 	void UnHook(log_cb cb);
 
+	// the calling thread's ring, made on first use
+	ThreadLogRing_t* GetThreadLogRing();
+	// false once shutting down, nothing waits on the logger thread from then on
+	bool IsRunning() const { return m_isRunning; }
+
+private:
+	void CollectLogs(std::vector<Log_t>& batch);
+	void CollectThreadRings(std::vector<Log_t>& batch);
+	void DispatchLogs(const std::vector<Log_t>& batch);
+
 public:
-	ThreadSafeQueue<Log_t>	m_queue;
-	ThreadSafeSet<std::string> m_filter;
-	bool					m_isFilterWhiteList = false;
+	MPMCRingQueue<Log_t>	m_queue{ LOGGER_QUEUE_CAPACITY };
+	ConcurrentHashSet<std::string> m_filter;	// checked by every log call
+	std::atomic<bool>		m_isFilterWhiteList{ false };
 	std::vector<log_cb>		m_hooks;
-	std::fstream			m_logFileStream;
-	std::fstream			m_currentLogFileStream;
-	bool					m_isFlushing = false;
+	Uptr<MappedLogFile>		m_logFile;
+	std::atomic<bool>		m_isFlushing{ false };
+	std::atomic<u32>		m_numDroppedLogs{ 0 };	// came in after the logger stopped
 
 
 private:
 	std::string				m_filePath = "Log/log";
 	threadHandle			m_thread;
-	bool					m_isRunning = true;
+	std::atomic<bool>		m_isRunning{ true };
 	SpinLock				m_hookLock;
+
+	u32								m_id;
+	SpinLock						m_threadRingsLock;
+	std::vector<ThreadLogRing_t*>	m_threadRings;
+	std::vector<LogRecord_t>		m_records;	// logger thread only
 };
 
 void LogTaggedPrintv(const std::string& tag, const char* format, va_list args);
@@ -45,6 +80,28 @@ void LogTaggedPrintf(const std::string& tag, const char* format, ...);
 void LogPrintf(const char* format, ...);
 void LogWarningf(const char* format, ...);
 void LogErrorf(const char* format, ...);
+
+void SubmitLogRecord(LogRecord_t& record);
+
+// Fast logs only copy the arguments and leave the formatting to the logger thread.
+// tag and format must be string literals, strings are copied (and cut past LOG_RECORD_STRING_BYTES).
+// Dropped instead of waiting when the thread's ring is full.
+template <typename... Args>
+void LogFastTaggedPrintf(const char* tag, const char* format, const Args&... args) {
+	static_assert(sizeof...(Args) <= LOG_RECORD_MAX_ARGS, "LogFastTaggedPrintf - too many arguments, raise LOG_RECORD_MAX_ARGS!");
+	LogRecord_t record;
+	record.m_tag = tag;
+	record.m_format = format;
+	record.m_numArgs = 0;
+	record.m_numStringBytes = 0;
+	CaptureLogArgs(record, args...);
+	SubmitLogRecord(record);
+}
+
+template <typename... Args>
+void LogFastPrintf(const char* format, const Args&... args) {
+	LogFastTaggedPrintf("log", format, args...);
+}
 void LogFlush();
 void LogShowAll();
 void LogHideAll();
@@ -0,0 +1,227 @@
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <compressapi.h>
+#pragma comment(lib, "Cabinet.lib")
+
+#include "Engine/Core/MappedLogFile.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include <cstring>
+#include <vector>
+
+static bool DoesFileExist(const std::string& path) {
+	return ::GetFileAttributesA(path.c_str()) != INVALID_FILE_ATTRIBUTES;
+}
+
+// a crashed run leaves the preallocated tail of its segment as zeros
+static void TrimCrashedSegment(const std::string& path) {
+	HANDLE file = ::CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		return;
+	}
+
+	LARGE_INTEGER fileSize;
+	if (::GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0) {
+		size_t size = (size_t)fileSize.QuadPart;
+		HANDLE mapping = ::CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		const char* view = mapping ? (const char*)::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+		if (view) {
+			while (size > 0 && view[size - 1] == '\0') {
+				--size;
+			}
+			::UnmapViewOfFile(view);
+		}
+		if (mapping) {
+			::CloseHandle(mapping);
+		}
+
+		LARGE_INTEGER end;
+		end.QuadPart = (LONGLONG)size;
+		::SetFilePointerEx(file, end, nullptr, FILE_BEGIN);
+		::SetEndOfFile(file);
+	}
+	::CloseHandle(file);
+}
+
+static bool CompressFile(const std::string& srcPath, const std::string& dstPath) {
+	HANDLE file = ::CreateFileA(srcPath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+
+	bool isCompressed = false;
+	LARGE_INTEGER fileSize;
+	HANDLE mapping = nullptr;
+	const void* view = nullptr;
+	COMPRESSOR_HANDLE compressor = nullptr;
+	if (::GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0
+		&& (mapping = ::CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr)) != nullptr
+		&& (view = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0)) != nullptr
+		&& ::CreateCompressor(COMPRESS_ALGORITHM_XPRESS_HUFF, nullptr, &compressor)) {
+		// ask for the size first
+		SIZE_T compressedSize = 0;
+		::Compress(compressor, view, (SIZE_T)fileSize.QuadPart, nullptr, 0, &compressedSize);
+		std::vector<char> compressed(compressedSize);
+		if (::Compress(compressor, view, (SIZE_T)fileSize.QuadPart, compressed.data(), compressed.size(), &compressedSize)) {
+			HANDLE dstFile = ::CreateFileA(dstPath.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+			if (dstFile != INVALID_HANDLE_VALUE) {
+				DWORD numWritten = 0;
+				isCompressed = ::WriteFile(dstFile, compressed.data(), (DWORD)compressedSize, &numWritten, nullptr) && numWritten == compressedSize;
+				::CloseHandle(dstFile);
+			}
+		}
+	}
+
+	if (compressor) {
+		::CloseCompressor(compressor);
+	}
+	if (view) {
+		::UnmapViewOfFile(view);
+	}
+	if (mapping) {
+		::CloseHandle(mapping);
+	}
+	::CloseHandle(file);
+	return isCompressed;
+}
+
+//------------------------------------------------------------------------
+MappedLogFile::MappedLogFile(const std::string& basePath, size_t segmentSize /*= LOG_SEGMENT_SIZE*/, int maxSegments /*= LOG_MAX_SEGMENTS*/)
+	: m_basePath(basePath)
+	, m_segmentSize(segmentSize)
+	, m_maxSegments(maxSegments) {
+	GUARANTEE_OR_DIE(maxSegments >= 1, "MappedLogFile - needs at least the current segment!");
+
+	// every run starts a segment of its own, the last run's becomes the first old one
+	std::string currentPath = GetSegmentPath(0, false);
+	if (DoesFileExist(currentPath)) {
+		TrimCrashedSegment(currentPath);
+		Rotate();
+	}
+	else {
+		OpenSegment();
+	}
+}
+
+MappedLogFile::~MappedLogFile() {
+	CloseSegment();
+}
+
+void MappedLogFile::Write(const char* text, size_t length) {
+	if (!IsOpen()) {
+		return;
+	}
+	if (length > m_segmentSize) {
+		length = m_segmentSize;
+	}
+	if (m_writeOffset + length > m_segmentSize) {
+		Rotate();
+		if (!IsOpen()) {
+			return;
+		}
+	}
+	memcpy(m_view + m_writeOffset, text, length);
+	m_writeOffset += length;
+}
+
+void MappedLogFile::WriteLine(const std::string& line) {
+	if (!IsOpen()) {
+		return;
+	}
+	// keep the line and its end in one segment
+	if (m_writeOffset + line.size() + 1 > m_segmentSize && line.size() + 1 <= m_segmentSize) {
+		Rotate();
+	}
+	Write(line.c_str(), line.size());
+	Write("\n", 1);
+}
+
+void MappedLogFile::Flush() {
+	if (IsOpen()) {
+		::FlushViewOfFile(m_view, m_writeOffset);
+	}
+}
+
+//------------------------------------------------------------------------
+bool MappedLogFile::OpenSegment() {
+	std::string path = GetSegmentPath(0, false);
+	HANDLE file = ::CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		DebuggerPrintf("MappedLogFile - Cannot create %s\n", path.c_str());
+		return false;
+	}
+
+	// mapping past the end grows the file, the whole segment is allocated up front
+	u64 segmentSize = m_segmentSize;
+	HANDLE mapping = ::CreateFileMappingA(file, nullptr, PAGE_READWRITE, (DWORD)(segmentSize >> 32), (DWORD)(segmentSize & 0xffffffff), nullptr);
+	char* view = mapping ? (char*)::MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, m_segmentSize) : nullptr;
+	if (view == nullptr) {
+		DebuggerPrintf("MappedLogFile - Cannot map %s\n", path.c_str());
+		if (mapping) {
+			::CloseHandle(mapping);
+		}
+		::CloseHandle(file);
+		return false;
+	}
+
+	m_file = file;
+	m_mapping = mapping;
+	m_view = view;
+	m_writeOffset = 0;
+	return true;
+}
+
+void MappedLogFile::CloseSegment() {
+	if (!IsOpen()) {
+		return;
+	}
+
+	::UnmapViewOfFile(m_view);
+	::CloseHandle((HANDLE)m_mapping);
+
+	// cut the unused part off
+	LARGE_INTEGER end;
+	end.QuadPart = (LONGLONG)m_writeOffset;
+	::SetFilePointerEx((HANDLE)m_file, end, nullptr, FILE_BEGIN);
+	::SetEndOfFile((HANDLE)m_file);
+	::CloseHandle((HANDLE)m_file);
+
+	m_file = nullptr;
+	m_mapping = nullptr;
+	m_view = nullptr;
+	m_writeOffset = 0;
+}
+
+void MappedLogFile::Rotate() {
+	CloseSegment();
+
+	// the oldest one falls off, everything else moves one up
+	::DeleteFileA(GetSegmentPath(m_maxSegments - 1, false).c_str());
+	::DeleteFileA(GetSegmentPath(m_maxSegments - 1, true).c_str());
+	for (int segmentIdx = m_maxSegments - 2; segmentIdx >= 1; --segmentIdx) {
+		for (bool isCompressed : { false, true }) {
+			std::string path = GetSegmentPath(segmentIdx, isCompressed);
+			if (DoesFileExist(path)) {
+				::MoveFileExA(path.c_str(), GetSegmentPath(segmentIdx + 1, isCompressed).c_str(), MOVEFILE_REPLACE_EXISTING);
+			}
+		}
+	}
+
+	if (m_maxSegments > 1) {
+		std::string rotatedPath = GetSegmentPath(1, false);
+		::MoveFileExA(GetSegmentPath(0, false).c_str(), rotatedPath.c_str(), MOVEFILE_REPLACE_EXISTING);
+		if (m_compressSegments && CompressFile(rotatedPath, GetSegmentPath(1, true))) {
+			::DeleteFileA(rotatedPath.c_str());
+		}
+	}
+
+	OpenSegment();
+}
+
+std::string MappedLogFile::GetSegmentPath(int segmentIdx, bool isCompressed) const {
+	std::string path = segmentIdx == 0 ? m_basePath + ".txt" : Stringf("%s.%d.txt", m_basePath.c_str(), segmentIdx);
+	if (isCompressed) {
+		path += ".xpress";
+	}
+	return path;
+}
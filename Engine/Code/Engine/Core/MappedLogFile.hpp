@@ -0,0 +1,50 @@
+#pragma once
+#include "Engine/Core/type.hpp"
+#include <atomic>
+#include <string>
+
+// size every segment is preallocated to
+constexpr size_t LOG_SEGMENT_SIZE = 8 * 1024 * 1024;
+// current segment included, older ones fall off
+constexpr int LOG_MAX_SEGMENTS = 8;
+
+// Log file written through a memory mapped view of a preallocated segment.
+// Lines are plain memory copies, the OS writes the pages out even if the process crashes,
+// so nothing is lost without a flush. A full segment rotates:
+//	log.txt -> log.1.txt -> ... -> log.<LOG_MAX_SEGMENTS - 1>.txt, then deleted
+// Rotated segments can be compressed (XPRESS Huffman, Windows compression API) to log.<n>.txt.xpress.
+// The segment a crashed run left behind has zeros at the end, they are trimmed on the next open.
+// Not thread safe apart from SetCompressSegments, the logger thread is the only writer.
+class MappedLogFile {
+public:
+	MappedLogFile(const std::string& basePath, size_t segmentSize = LOG_SEGMENT_SIZE, int maxSegments = LOG_MAX_SEGMENTS);
+	~MappedLogFile();
+	MappedLogFile(const MappedLogFile&) = delete;
+	MappedLogFile& operator=(const MappedLogFile&) = delete;
+
+	bool IsOpen() const { return m_view != nullptr; }
+	void Write(const char* text, size_t length);
+	void WriteLine(const std::string& line);
+	// starts writing the dirty pages out, only matters if the whole machine goes down
+	void Flush();
+
+	void SetCompressSegments(bool compressSegments) { m_compressSegments = compressSegments; }
+	bool IsCompressingSegments() const { return m_compressSegments; }
+
+private:
+	bool OpenSegment();
+	void CloseSegment();
+	void Rotate();
+	std::string GetSegmentPath(int segmentIdx, bool isCompressed) const;
+
+private:
+	std::string		m_basePath;
+	size_t			m_segmentSize;
+	int				m_maxSegments;
+	std::atomic<bool>	m_compressSegments{ false };
+
+	void*			m_file = nullptr;		// HANDLE
+	void*			m_mapping = nullptr;	// HANDLE
+	char*			m_view = nullptr;
+	size_t			m_writeOffset = 0;
+};
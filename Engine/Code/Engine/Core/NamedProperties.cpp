@@ -0,0 +1,143 @@
+#include "Engine/Core/NamedProperties.hpp"
+
+NamedProperties::~NamedProperties() {
+	Clear();
+}
+
+NamedProperties::NamedProperties(const NamedProperties& other) {
+	CopyFrom(other);
+}
+
+NamedProperties::NamedProperties(NamedProperties&& other)
+	: m_slots(std::move(other.m_slots))
+	, m_capacity(other.m_capacity)
+	, m_numProperties(other.m_numProperties) {
+	other.m_capacity = 0;
+	other.m_numProperties = 0;
+}
+
+NamedProperties& NamedProperties::operator=(const NamedProperties& other) {
+	if (this != &other) {
+		Clear();
+		CopyFrom(other);
+	}
+	return *this;
+}
+
+NamedProperties& NamedProperties::operator=(NamedProperties&& other) {
+	if (this != &other) {
+		Clear();
+		m_slots = std::move(other.m_slots);
+		m_capacity = other.m_capacity;
+		m_numProperties = other.m_numProperties;
+		other.m_capacity = 0;
+		other.m_numProperties = 0;
+	}
+	return *this;
+}
+
+bool NamedProperties::Remove(StringId key) {
+	PropertySlot_t* slot = FindSlot(key);
+	if (slot == nullptr) {
+		return false;
+	}
+	slot->m_type->m_destroy(&slot->m_storage);
+
+	// shift the rest of the run back so no probe stops early, no tombstones needed
+	u32 mask = m_capacity - 1;
+	u32 holeIdx = (u32)(slot - m_slots.get());
+	u32 slotIdx = (holeIdx + 1) & mask;
+	while (m_slots[slotIdx].m_key != INVALID_STRING_ID) {
+		PropertySlot_t& next = m_slots[slotIdx];
+		u32 homeIdx = next.m_key & mask;
+		// move it only if the hole lies between its home and where it is now
+		if (((slotIdx - homeIdx) & mask) >= ((slotIdx - holeIdx) & mask)) {
+			PropertySlot_t& hole = m_slots[holeIdx];
+			hole.m_key = next.m_key;
+			hole.m_type = next.m_type;
+			next.m_type->m_move(&hole.m_storage, &next.m_storage);
+			holeIdx = slotIdx;
+		}
+		slotIdx = (slotIdx + 1) & mask;
+	}
+	m_slots[holeIdx].m_key = INVALID_STRING_ID;
+	m_slots[holeIdx].m_type = nullptr;
+	--m_numProperties;
+	return true;
+}
+
+void NamedProperties::Clear() {
+	for (u32 slotIdx = 0; slotIdx < m_capacity && m_numProperties > 0; ++slotIdx) {
+		PropertySlot_t& slot = m_slots[slotIdx];
+		if (slot.m_key != INVALID_STRING_ID) {
+			slot.m_type->m_destroy(&slot.m_storage);
+			slot.m_key = INVALID_STRING_ID;
+			slot.m_type = nullptr;
+			--m_numProperties;
+		}
+	}
+}
+
+PropertySlot_t* NamedProperties::FindSlot(StringId key) const {
+	if (m_numProperties == 0 || key == INVALID_STRING_ID) {
+		return nullptr;
+	}
+	u32 mask = m_capacity - 1;
+	for (u32 slotIdx = key & mask; ; slotIdx = (slotIdx + 1) & mask) {
+		PropertySlot_t& slot = m_slots[slotIdx];
+		if (slot.m_key == key) {
+			return &slot;
+		}
+		// never full, an empty slot always ends the run
+		if (slot.m_key == INVALID_STRING_ID) {
+			return nullptr;
+		}
+	}
+}
+
+PropertySlot_t& NamedProperties::ClaimSlot(StringId key) {
+	u32 mask = m_capacity - 1;
+	u32 slotIdx = key & mask;
+	while (m_slots[slotIdx].m_key != INVALID_STRING_ID) {
+		slotIdx = (slotIdx + 1) & mask;
+	}
+	PropertySlot_t& slot = m_slots[slotIdx];
+	slot.m_key = key;
+	++m_numProperties;
+	return slot;
+}
+
+void NamedProperties::Grow() {
+	Uptr<PropertySlot_t[]> oldSlots = std::move(m_slots);
+	u32 oldCapacity = m_capacity;
+
+	m_capacity = m_capacity == 0 ? PROPERTY_MIN_CAPACITY : m_capacity * 2;
+	m_slots.reset(new PropertySlot_t[m_capacity]);
+	m_numProperties = 0;
+	for (u32 slotIdx = 0; slotIdx < oldCapacity; ++slotIdx) {
+		PropertySlot_t& oldSlot = oldSlots[slotIdx];
+		if (oldSlot.m_key != INVALID_STRING_ID) {
+			PropertySlot_t& slot = ClaimSlot(oldSlot.m_key);
+			slot.m_type = oldSlot.m_type;
+			oldSlot.m_type->m_move(&slot.m_storage, &oldSlot.m_storage);
+		}
+	}
+}
+
+void NamedProperties::CopyFrom(const NamedProperties& other) {
+	if (other.m_numProperties == 0) {
+		return;
+	}
+	if (m_capacity < other.m_capacity) {
+		m_slots.reset(new PropertySlot_t[other.m_capacity]);
+		m_capacity = other.m_capacity;
+	}
+	for (u32 slotIdx = 0; slotIdx < other.m_capacity; ++slotIdx) {
+		const PropertySlot_t& otherSlot = other.m_slots[slotIdx];
+		if (otherSlot.m_key != INVALID_STRING_ID) {
+			PropertySlot_t& slot = ClaimSlot(otherSlot.m_key);
+			otherSlot.m_type->m_copy(&slot.m_storage, &otherSlot.m_storage);
+			slot.m_type = otherSlot.m_type;
+		}
+	}
+}
@@ -1,74 +1,166 @@
 #pragma once
+#include "Engine/Core/type.hpp"
+#include "Engine/Core/StringId.hpp"
 #include "Engine/Core/ErrorWarningAssert.hpp"
+#include <new>
 #include <string>
-#include <map>
-#include <memory>
+#include <type_traits>
+#include <utility>
 
-class PropertyBase {
-public:
-	PropertyBase() = default;
-	virtual ~PropertyBase() = default;
-	template<typename T>
-	const T& Get() const {
-		const Property<T>* ptr = dynamic_cast<const Property<T>*>(this);
-		if (!ptr) {
-			ERROR_AND_DIE("Named property type does not match!");
-		}
-		else {
-			return ptr->Get();
-		}
-	}
+// values this size or smaller live in the slot itself, bigger ones get a heap block
+constexpr size_t PROPERTY_INLINE_SIZE = 32;
+constexpr u32 PROPERTY_MIN_CAPACITY = 8;
 
-	template<typename T>
-	void Set(const T& rhs) {
-		dynamic_cast<Property<T>*>(this)->Set(rhs);
+// what a slot needs to know about the type it holds
+struct PropertyType_t {
+	TypeId	m_typeId;
+	void*	(*m_getValue)(void* storage);
+	void	(*m_copy)(void* dst, const void* src);
+	void	(*m_move)(void* dst, void* src);	// src is left destroyed
+	void	(*m_destroy)(void* storage);
+};
+
+template<typename T, bool IS_INLINE = (sizeof(T) <= PROPERTY_INLINE_SIZE && alignof(T) <= alignof(void*))>
+struct PropertyStorage;
+
+template<typename T>
+struct PropertyStorage<T, true> {
+	static void* GetValue(void* storage) { return storage; }
+	static void Construct(void* storage, const T& value) { new (storage) T(value); }
+	static void Copy(void* dst, const void* src) { new (dst) T(*static_cast<const T*>(src)); }
+	static void Move(void* dst, void* src) {
+		T* srcValue = static_cast<T*>(src);
+		new (dst) T(std::move(*srcValue));
+		srcValue->~T();
 	}
+	static void Destroy(void* storage) { static_cast<T*>(storage)->~T(); }
 };
 
-template <typename T>
-class Property : public PropertyBase {
-public:
-	Property() = default;
-	virtual ~Property() = default;
-	Property(const T& rhs) : m_value(rhs) {}
-	const T& Get() const { return m_value; }
-	void Set(const T& rhs) { m_value = rhs; }
+// the storage holds a T*
+template<typename T>
+struct PropertyStorage<T, false> {
+	static void* GetValue(void* storage) { return *static_cast<T**>(storage); }
+	static void Construct(void* storage, const T& value) { *static_cast<T**>(storage) = new T(value); }
+	static void Copy(void* dst, const void* src) { *static_cast<T**>(dst) = new T(**static_cast<T* const*>(src)); }
+	static void Move(void* dst, void* src) { *static_cast<T**>(dst) = *static_cast<T**>(src); }
+	static void Destroy(void* storage) { delete *static_cast<T**>(storage); }
+};
 
-private:
-	T m_value;
+template<typename T>
+const PropertyType_t* GetPropertyType() {
+	static const PropertyType_t s_type = {
+		GetTypeId<T>(),
+		&PropertyStorage<T>::GetValue,
+		&PropertyStorage<T>::Copy,
+		&PropertyStorage<T>::Move,
+		&PropertyStorage<T>::Destroy
+	};
+	return &s_type;
+}
+
+struct PropertySlot_t {
+	StringId				m_key = INVALID_STRING_ID;	// empty slot
+	const PropertyType_t*	m_type = nullptr;
+	std::aligned_storage<PROPERTY_INLINE_SIZE, alignof(void*)>::type m_storage;
 };
 
+// Values of any copyable type by name. Open addressed, linear probing on the StringId,
+// small values stored inline, so a lookup is a hash, a probe and a type id compare.
+// String keys are hashed on the spot, SID("Key") skips even that.
 class NamedProperties {
 public:
 	NamedProperties() = default;
-	~NamedProperties() {
-		for (auto& it : m_properties) {
-			delete it.second;
-		}
-	}
+	~NamedProperties();
+	NamedProperties(const NamedProperties& other);
+	NamedProperties(NamedProperties&& other);
+	NamedProperties& operator=(const NamedProperties& other);
+	NamedProperties& operator=(NamedProperties&& other);
 
+	// a value of another type replaces the old one
 	template<typename T>
-	void Set(const std::string& key, const T& value) {
-		if (m_properties.find(key) != m_properties.end()) {
-			m_properties[key]->Set<T>(value);
-		}
-		else {
-			PropertyBase* base = new Property<T>();
-			base->Set<T>(value);
-			m_properties[key] = base;
-		}
-	}
+	void Set(StringId key, const T& value);
+	template<typename T>
+	void Set(const std::string& key, const T& value) { Set(CreateOrGetStringId(key), value); }
+	void Set(StringId key, const char* value) { Set(key, std::string(value)); }
+	void Set(const std::string& key, const char* value) { Set(CreateOrGetStringId(key), std::string(value)); }
 
+	// defaultValue if the key is missing, dies if it holds another type
 	template<typename T>
-	const T& Get(const std::string& key, const T& defaultValue) {
-		if (m_properties.find(key) != m_properties.end()) {
-			return m_properties[key]->Get<T>();
-		}
-		else {
-			return defaultValue;
+	const T& Get(StringId key, const T& defaultValue) const;
+	template<typename T>
+	const T& Get(const std::string& key, const T& defaultValue) const { return Get(HashStringId(key.c_str(), key.size()), defaultValue); }
+	// nullptr if the key is missing or holds another type
+	template<typename T>
+	T* Find(StringId key);
+	template<typename T>
+	const T* Find(StringId key) const { return const_cast<NamedProperties*>(this)->Find<T>(key); }
+
+	bool	Contains(StringId key) const { return FindSlot(key) != nullptr; }
+	bool	Remove(StringId key);
+	void	Clear();
+	size_t	GetSize() const { return m_numProperties; }
+
+private:
+	PropertySlot_t*	FindSlot(StringId key) const;
+	// the key must not be in yet and there must be room
+	PropertySlot_t&	ClaimSlot(StringId key);
+	bool			IsFullForInsert() const { return (m_numProperties + 1) * 4 > m_capacity * 3; }
+	void			Grow();
+	void			CopyFrom(const NamedProperties& other);
+
+private:
+	Uptr<PropertySlot_t[]>	m_slots;
+	u32						m_capacity = 0;	// power of 2
+	u32						m_numProperties = 0;
+};
+
+//------------------------------------------------------------------------
+template<typename T>
+void NamedProperties::Set(StringId key, const T& value) {
+	GUARANTEE_OR_DIE(key != INVALID_STRING_ID, "NamedProperties - Invalid key!");
+	const PropertyType_t* type = GetPropertyType<T>();
+	PropertySlot_t* slot = FindSlot(key);
+	if (slot) {
+		if (slot->m_type == type) {
+			*static_cast<T*>(type->m_getValue(&slot->m_storage)) = value;
+			return;
 		}
+		slot->m_type->m_destroy(&slot->m_storage);
+		slot->m_type = nullptr;
+		PropertyStorage<T>::Construct(&slot->m_storage, value);
+		slot->m_type = type;
+		return;
 	}
 
-private:
-	std::map<std::string, PropertyBase*> m_properties;
-};
\ No newline at end of file
+	if (IsFullForInsert()) {
+		// the value may be one of ours, growing moves them all
+		T copy(value);
+		Grow();
+		slot = &ClaimSlot(key);
+		PropertyStorage<T>::Construct(&slot->m_storage, copy);
+	}
+	else {
+		slot = &ClaimSlot(key);
+		PropertyStorage<T>::Construct(&slot->m_storage, value);
+	}
+	slot->m_type = type;
+}
+
+template<typename T>
+const T& NamedProperties::Get(StringId key, const T& defaultValue) const {
+	PropertySlot_t* slot = FindSlot(key);
+	if (slot == nullptr) {
+		return defaultValue;
+	}
+	GUARANTEE_OR_DIE(slot->m_type->m_typeId == GetTypeId<T>(), "Named property type does not match!");
+	return *static_cast<const T*>(slot->m_type->m_getValue(&slot->m_storage));
+}
+
+template<typename T>
+T* NamedProperties::Find(StringId key) {
+	PropertySlot_t* slot = FindSlot(key);
+	if (slot == nullptr || slot->m_type->m_typeId != GetTypeId<T>()) {
+		return nullptr;
+	}
+	return static_cast<T*>(slot->m_type->m_getValue(&slot->m_storage));
+}
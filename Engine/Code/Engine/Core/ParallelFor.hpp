@@ -0,0 +1,90 @@
+#pragma once
+#include "Engine/Core/JobSystem.hpp"
+#include <algorithm>
+#include <vector>
+
+// Runs rangeFunc(chunkBegin, chunkEnd) for one chunk of a ParallelFor/ParallelReduce.
+// Only holds a reference, the caller waits for all chunks before rangeFunc goes away.
+template <typename RangeFunc>
+class ParallelRangeJob : public Job {
+public:
+	ParallelRangeJob(int begin, int end, const RangeFunc& rangeFunc)
+		: m_begin(begin), m_end(end), m_rangeFunc(rangeFunc) {
+		m_isCompleteCallbackEnabled = false;
+	}
+	virtual void Execute() override { m_rangeFunc(m_begin, m_end); }
+	virtual void JobCompleteCallback() override {}
+
+private:
+	int					m_begin;
+	int					m_end;
+	const RangeFunc&	m_rangeFunc;
+};
+
+// Splits [begin, end) into chunks of grain and runs rangeFunc(chunkBegin, chunkEnd) on the job workers.
+// The calling thread runs the first chunk itself and helps with the rest until all are done.
+// Runs serially when there is no job system or no worker to share the work with.
+template <typename RangeFunc>
+void ParallelForRange(int begin, int end, int grain, const RangeFunc& rangeFunc) {
+	if (end <= begin) {
+		return;
+	}
+	grain = std::max(grain, 1);
+	int chunkCount = (end - begin + grain - 1) / grain;
+	if (chunkCount == 1 || !g_theJobSystem || g_theJobSystem->GetWorkerThreadCount() == 0) {
+		rangeFunc(begin, end);
+		return;
+	}
+
+	std::vector<JobHandle> handles;
+	handles.reserve(chunkCount - 1);
+	for (int chunkIdx = 1; chunkIdx < chunkCount; ++chunkIdx) {
+		int chunkBegin = begin + chunkIdx * grain;
+		int chunkEnd = std::min(chunkBegin + grain, end);
+		handles.push_back(g_theJobSystem->QueueJob(std::make_unique<ParallelRangeJob<RangeFunc>>(chunkBegin, chunkEnd, rangeFunc)));
+	}
+
+	rangeFunc(begin, std::min(begin + grain, end));
+	for (auto& handle : handles) {
+		g_theJobSystem->WaitFor(handle);
+	}
+}
+
+// Calls func(i) for every i in [begin, end), grain indices per job.
+template <typename Func>
+void ParallelFor(int begin, int end, int grain, const Func& func) {
+	auto rangeFunc = [&func](int chunkBegin, int chunkEnd) {
+		for (int i = chunkBegin; i < chunkEnd; ++i) {
+			func(i);
+		}
+	};
+	ParallelForRange(begin, end, grain, rangeFunc);
+}
+
+// rangeFunc(chunkBegin, chunkEnd) returns the partial result of one chunk,
+// combineFunc(a, b) merges two of them. Partials are combined in order, so the result
+// is the same from run to run even for non-associative math like float sums.
+template <typename T, typename RangeFunc, typename CombineFunc>
+T ParallelReduce(int begin, int end, int grain, const T& identity, const RangeFunc& rangeFunc, const CombineFunc& combineFunc) {
+	if (end <= begin) {
+		return identity;
+	}
+	grain = std::max(grain, 1);
+	int chunkCount = (end - begin + grain - 1) / grain;
+	std::vector<T> partials(chunkCount, identity);
+
+	auto chunkFunc = [&](int chunkBegin, int chunkEnd) {
+		for (int chunkIdx = chunkBegin; chunkIdx < chunkEnd; ++chunkIdx) {
+			int rangeBegin = begin + chunkIdx * grain;
+			int rangeEnd = std::min(rangeBegin + grain, end);
+			partials[chunkIdx] = rangeFunc(rangeBegin, rangeEnd);
+		}
+	};
+	ParallelForRange(0, chunkCount, 1, chunkFunc);
+
+	T result = identity;
+	for (auto& partial : partials) {
+		result = combineFunc(result, partial);
+	}
+	return result;
+}
@@ -2,6 +2,7 @@
 #include "Engine/Core/StringUtils.hpp"
 #include "Engine/Core/EngineCommon.hpp"
 #include "Engine/Core/ResourceManager.hpp"
+#include "Engine/Core/Task.hpp"
 #include "Engine/Renderer/d3d11/RHIInstance.hpp"
 #include "Engine/Renderer/FBXLoader.hpp"
 #include "ThirdParty/pugixml/pugixml.hpp"
@@ -14,17 +15,37 @@ ResourceManager::~ResourceManager() {
 }
 
 void ResourceManager::LoadTexture2D(const std::string& name, const std::string& filePath) {
-	if (m_texture2Ds.find(name) != m_texture2Ds.end()) {
+	if (m_texture2Ds.Contains(name)) {
 		return;
 	}
 	RHIDevice* device = g_theRHI->GetDevice();
 	std::unique_ptr<Texture2D> texture = device->CreateTexture2DFromFile(filePath);
 	texture->m_sampler = GetSampler("nearest");
-	m_texture2Ds.insert({ name, std::move(texture) });
+	m_texture2Ds.Insert(name, std::move(texture));
+}
+
+Task<void> ResourceManager::LoadTexture2DAsync(std::string name, std::string filePath) {
+	if (m_texture2Ds.Contains(name)) {
+		co_return;
+	}
+
+	std::vector<char> fileData = co_await ReadFileAsync(filePath);
+	co_await ResumeOnWorker(JOB_CHANNEL_MASK_COMPUTE);
+	std::unique_ptr<Image> image = std::make_unique<Image>(fileData, false);
+
+	co_await ResumeOnMainThread();
+	// someone else may have loaded it in the meantime
+	if (m_texture2Ds.Contains(name)) {
+		co_return;
+	}
+	RHIDevice* device = g_theRHI->GetDevice();
+	std::unique_ptr<Texture2D> texture = device->CreateTexture2DFromImage(std::move(image));
+	texture->m_sampler = GetSampler("nearest");
+	m_texture2Ds.Insert(name, std::move(texture));
 }
 
 void ResourceManager::LoadShaderProgram(const std::string& name, const std::string& filePath, eShaderType type) {
-	if (m_shaderPrograms.find(name) != m_shaderPrograms.end()) {
+	if (m_shaderPrograms.Contains(name)) {
 		return;
 	}
 
@@ -35,13 +56,13 @@ void ResourceManager::LoadShaderProgram(const std::string& name, const std::stri
 	case SHADER_TYPE_PIXEL_SHADER:	shaderProgram = device->CreatePixelShader(filePath);	break;
 	default: DebuggerPrintf("Unsupported shader type.\n"); break;
 	}
-	m_shaderPrograms.insert({ name, std::move(shaderProgram) });
+	m_shaderPrograms.Insert(name, std::move(shaderProgram));
 }
 
 
 
 void ResourceManager::LoadMaterial(const std::string& name, const std::string& filePath) {
-	if (m_materials.find(name) != m_materials.end()) {
+	if (m_materials.Contains(name)) {
 		return;
 	}
 	pugi::xml_document doc;
@@ -125,41 +146,41 @@ void ResourceManager::LoadMaterial(const std::string& name, const std::string& f
 				newMaterial->m_depthStencilState = device->CreateDepthStencilState(depthTestEnable, ToCompareFunc(depthTestComapre), STENCIL_OP_KEEP);
 			}
 		}
-		m_materials.insert({ name, std::move(newMaterial) });
+		m_materials.Insert(name, std::move(newMaterial));
 	}	
 }
 
 
 void ResourceManager::LoadSampler(const std::string& name) {
-	if (m_samplers.find(name) != m_samplers.end()) {
+	if (m_samplers.Contains(name)) {
 		return;
 	}
 	std::unique_ptr<Sampler> newSampler = std::make_unique<Sampler>();
 	if (name == "linear") {
 		RHIDevice* device = g_theRHI->GetDevice();
 		newSampler = device->CreateSampler(FILTER_TYPE_MIN_MAG_MIP_LINEAR, WRAP_MODE_LOOP, WRAP_MODE_LOOP, WRAP_MODE_LOOP);
-		m_samplers.insert({ name, std::move(newSampler) });
+		m_samplers.Insert(name, std::move(newSampler));
 	}
 	else if (name == "nearest") {
 		RHIDevice* device = g_theRHI->GetDevice();
 		newSampler = device->CreateSampler(FILTER_TYPE_MIN_MAG_MIP_POINT, WRAP_MODE_LOOP, WRAP_MODE_LOOP, WRAP_MODE_LOOP);
-		m_samplers.insert({ name, std::move(newSampler) });
+		m_samplers.Insert(name, std::move(newSampler));
 	}
 }
 
 void ResourceManager::LoadSpriteSheet(const std::string& name, const std::string& filePath, const IntVector2& layout) {
-	if (m_spriteSheets.find(name) != m_spriteSheets.end()) {
+	if (m_spriteSheets.Contains(name)) {
 		return;
 	}
 
 	LoadTexture2D(name, filePath);
 	Texture2D* texture = GetTexture2D(name);
 	Uptr<SpriteSheet> newSpriteSheet = std::make_unique<SpriteSheet>(texture, layout);
-	m_spriteSheets.insert({ name, std::move(newSpriteSheet) });
+	m_spriteSheets.Insert(name, std::move(newSpriteSheet));
 }
 
 void ResourceManager::LoadSkeletalMesh(const std::string& name, const std::string& filePath) {
-	if (m_skeletalMeshes.find(name) != m_skeletalMeshes.end()) {
+	if (m_skeletalMeshes.Contains(name)) {
 		return;
 	}
 
@@ -167,7 +188,7 @@ void ResourceManager::LoadSkeletalMesh(const std::string& name, const std::strin
 	fbxLoader.LoadFromFile(filePath);
 
 	Uptr<SkeletalMesh> newSkeletalMesh = fbxLoader.CreateSkeletalMesh();
-	m_skeletalMeshes.insert({ name, std::move(newSkeletalMesh) });
+	m_skeletalMeshes.Insert(name, std::move(newSkeletalMesh));
 }
 
 // void ResourceManager::LoadSpriteSheet(const std::string& name, const std::string& filePath, const IntVector2& layout) {
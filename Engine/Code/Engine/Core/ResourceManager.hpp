@@ -9,16 +9,19 @@
 #include "Engine/Renderer/SkeletalMesh.hpp"
 #include "Engine/Renderer/Animation.hpp"
 #include "Engine/Math/IntVector2.hpp"
-#include <unordered_map>
+#include "Engine/Core/ThreadSafeContainer.hpp"
 #include <string>
 #include <vector>
 
+template <typename T> class Task;
+
 class ResourceManager{
 public:
 	ResourceManager();
 	~ResourceManager();
 
 	void				LoadTexture2D(const std::string& name, const std::string& filePath);
+	Task<void>			LoadTexture2DAsync(std::string name, std::string filePath); // reads and decodes on workers, creates the texture on the main thread
 	Texture2D*			GetTexture2D(const std::string& name) const;
 
 	void				LoadShaderProgram(const std::string& name, const std::string& filePath, eShaderType type);
@@ -43,60 +46,55 @@ public:
 // 	SpriteAnimation*	GetSpriteAnimation(const std::string& name);
 
 private:
-	std::unordered_map<std::string, Uptr<Texture2D>>			m_texture2Ds;
-	std::unordered_map<std::string, Uptr<ShaderProgram>>		m_shaderPrograms;
-	std::unordered_map<std::string, Uptr<Material>>				m_materials;
-	std::unordered_map<std::string, Uptr<Sampler>>				m_samplers;
-	std::unordered_map<std::string, Uptr<SpriteSheet>>			m_spriteSheets;
-	std::unordered_map<std::string, Uptr<SkeletalMesh>>			m_skeletalMeshes;
-	std::unordered_map<std::string, Uptr<Animation>>			m_animations;
+	// looked up from any thread, loads may finish on workers
+	template <typename T>
+	using ResourceMap = ConcurrentHashMap<std::string, Uptr<T>>;
+
+	// resources are only freed with the manager, so the pointer outlives the shard lock
+	template <typename T>
+	static T* FindLoaded(const ResourceMap<T>& resources, const std::string& name);
+
+private:
+	ResourceMap<Texture2D>			m_texture2Ds;
+	ResourceMap<ShaderProgram>		m_shaderPrograms;
+	ResourceMap<Material>			m_materials;
+	ResourceMap<Sampler>			m_samplers;
+	ResourceMap<SpriteSheet>		m_spriteSheets;
+	ResourceMap<SkeletalMesh>		m_skeletalMeshes;
+	ResourceMap<Animation>			m_animations;
 };
 
+template <typename T>
+T* ResourceManager::FindLoaded(const ResourceMap<T>& resources, const std::string& name) {
+	T* resource = nullptr;
+	resources.Visit(name, [&resource](const Uptr<T>& loaded) { resource = loaded.get(); });
+	return resource;
+}
+
 inline Texture2D* ResourceManager::GetTexture2D(const std::string& name) const{
-	if (m_texture2Ds.find(name) == m_texture2Ds.end()) {
-		return nullptr;
-	}
-	return m_texture2Ds.at(name).get();
+	return FindLoaded(m_texture2Ds, name);
 }
 
 inline ShaderProgram* ResourceManager::GetShaderProgram(const std::string& name) {
-	if (m_shaderPrograms.find(name) == m_shaderPrograms.end()) {
-		return nullptr;
-	}
-	return m_shaderPrograms.at(name).get();
+	return FindLoaded(m_shaderPrograms, name);
 }
 
 inline Material* ResourceManager::GetMaterial(const std::string& name) {
-	if (m_materials.find(name) == m_materials.end()) {
-		return nullptr;
-	}
-	return m_materials.at(name).get();
+	return FindLoaded(m_materials, name);
 }
 
 inline Sampler* ResourceManager::GetSampler(const std::string& name) {
-	if (m_samplers.find(name) == m_samplers.end()) {
-		return nullptr;
-	}
-	return m_samplers.at(name).get();
+	return FindLoaded(m_samplers, name);
 }
 
 inline SpriteSheet* ResourceManager::GetSpriteSheet(const std::string& name) {
-	if (m_spriteSheets.find(name) == m_spriteSheets.end()) {
-		return nullptr;
-	}
-	return m_spriteSheets.at(name).get();
+	return FindLoaded(m_spriteSheets, name);
 }
 
 inline SkeletalMesh* ResourceManager::GetSkeletalMesh(const std::string& name) {
-	if (m_skeletalMeshes.find(name) == m_skeletalMeshes.end()) {
-		return nullptr;
-	}
-	return m_skeletalMeshes.at(name).get();
+	return FindLoaded(m_skeletalMeshes, name);
 }
 
 inline Animation* ResourceManager::GetAnimation(const std::string& name) {
-	if (m_animations.find(name) == m_animations.end()) {
-		return nullptr;
-	}
-	return m_animations.at(name).get();
+	return FindLoaded(m_animations, name);
 }
\ No newline at end of file
@@ -0,0 +1,302 @@
+#pragma once
+#include "Engine/Core/type.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Core/ThreadSafeContainer.hpp"
+#include <atomic>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Bounded lock free queue, any number of producers and consumers.
+// Every slot carries a sequence number telling whose turn it is, so producers and
+// consumers only ever race on their own index. Capacity is rounded up to a power of 2.
+// Try* never block, when the queue is full or empty they return false and leave the value alone.
+template <typename T>
+class MPMCRingQueue {
+public:
+	explicit MPMCRingQueue(size_t capacity);
+	~MPMCRingQueue();
+	MPMCRingQueue(const MPMCRingQueue&) = delete;
+	MPMCRingQueue& operator=(const MPMCRingQueue&) = delete;
+
+	bool TryEnqueue(T&& v) { return Emplace(std::move(v)); }
+	bool TryEnqueue(const T& v) { return Emplace(v); }
+	bool TryDequeue(T& out);
+	// appends up to maxCount items to out, claiming them all with one CAS
+	size_t DequeueBatch(std::vector<T>& out, size_t maxCount);
+
+	size_t GetCapacity() const { return m_mask + 1; }
+	size_t GetApproxSize() const;
+
+private:
+	struct Cell_t {
+		std::atomic<size_t> m_sequence;
+		typename std::aligned_storage<sizeof(T), alignof(T)>::type m_storage;
+
+		T* GetItem() { return reinterpret_cast<T*>(&m_storage); }
+	};
+
+	template <typename U>
+	bool Emplace(U&& v);
+
+private:
+	Cell_t*					m_cells;
+	size_t					m_mask;
+
+	// producers and consumers each get their own cache line
+	char					m_pad0[CACHE_LINE_SIZE];
+	std::atomic<size_t>		m_enqueuePos{ 0 };
+	char					m_pad1[CACHE_LINE_SIZE - sizeof(std::atomic<size_t>)];
+	std::atomic<size_t>		m_dequeuePos{ 0 };
+	char					m_pad2[CACHE_LINE_SIZE - sizeof(std::atomic<size_t>)];
+};
+
+// Bounded lock free queue for exactly one producer thread and one consumer thread.
+// Each side keeps a stale copy of the other's index and only reloads it when it looks full/empty.
+template <typename T>
+class SPSCRingQueue {
+public:
+	explicit SPSCRingQueue(size_t capacity);
+	~SPSCRingQueue();
+	SPSCRingQueue(const SPSCRingQueue&) = delete;
+	SPSCRingQueue& operator=(const SPSCRingQueue&) = delete;
+
+	// producer only
+	bool TryEnqueue(T&& v) { return Emplace(std::move(v)); }
+	bool TryEnqueue(const T& v) { return Emplace(v); }
+
+	// consumer only
+	bool TryDequeue(T& out);
+	size_t DequeueBatch(std::vector<T>& out, size_t maxCount);
+
+	size_t GetCapacity() const { return m_mask + 1; }
+	size_t GetApproxSize() const;
+
+private:
+	typedef typename std::aligned_storage<sizeof(T), alignof(T)>::type Slot_t;
+
+	T* GetItem(size_t pos) { return reinterpret_cast<T*>(&m_slots[pos & m_mask]); }
+
+	template <typename U>
+	bool Emplace(U&& v);
+
+private:
+	Slot_t*					m_slots;
+	size_t					m_mask;
+
+	char					m_pad0[CACHE_LINE_SIZE];
+	// written by the producer
+	std::atomic<size_t>		m_tail{ 0 };
+	size_t					m_cachedHead = 0;
+	char					m_pad1[CACHE_LINE_SIZE - sizeof(std::atomic<size_t>) - sizeof(size_t)];
+	// written by the consumer
+	std::atomic<size_t>		m_head{ 0 };
+	size_t					m_cachedTail = 0;
+	char					m_pad2[CACHE_LINE_SIZE - sizeof(std::atomic<size_t>) - sizeof(size_t)];
+};
+
+inline size_t RoundUpToPowerOf2(size_t v) {
+	size_t result = 1;
+	while (result < v) {
+		result <<= 1;
+	}
+	return result;
+}
+
+//------------------------------------------------------------------------
+template <typename T>
+MPMCRingQueue<T>::MPMCRingQueue(size_t capacity) {
+	GUARANTEE_OR_DIE(capacity >= 2, "MPMCRingQueue - capacity must be at least 2!");
+	size_t numCells = RoundUpToPowerOf2(capacity);
+	m_mask = numCells - 1;
+	m_cells = new Cell_t[numCells];
+	for (size_t cellIdx = 0; cellIdx < numCells; ++cellIdx) {
+		m_cells[cellIdx].m_sequence.store(cellIdx, std::memory_order_relaxed);
+	}
+}
+
+template <typename T>
+MPMCRingQueue<T>::~MPMCRingQueue() {
+	size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+	size_t end = m_enqueuePos.load(std::memory_order_relaxed);
+	for (; pos != end; ++pos) {
+		m_cells[pos & m_mask].GetItem()->~T();
+	}
+	delete[] m_cells;
+}
+
+template <typename T>
+template <typename U>
+bool MPMCRingQueue<T>::Emplace(U&& v) {
+	size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+	for (;;) {
+		Cell_t& cell = m_cells[pos & m_mask];
+		size_t sequence = cell.m_sequence.load(std::memory_order_acquire);
+		intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+		if (diff == 0) {
+			// the slot is free, try to claim it
+			if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+				new (&cell.m_storage) T(std::forward<U>(v));
+				cell.m_sequence.store(pos + 1, std::memory_order_release);
+				return true;
+			}
+		}
+		else if (diff < 0) {
+			// a lap behind, the consumer hasn't freed it yet
+			return false;
+		}
+		else {
+			pos = m_enqueuePos.load(std::memory_order_relaxed);
+		}
+	}
+}
+
+template <typename T>
+bool MPMCRingQueue<T>::TryDequeue(T& out) {
+	size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+	for (;;) {
+		Cell_t& cell = m_cells[pos & m_mask];
+		size_t sequence = cell.m_sequence.load(std::memory_order_acquire);
+		intptr_t diff = (intptr_t)sequence - (intptr_t)(pos + 1);
+		if (diff == 0) {
+			if (m_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+				T* item = cell.GetItem();
+				out = std::move(*item);
+				item->~T();
+				// free for the producer one lap ahead
+				cell.m_sequence.store(pos + m_mask + 1, std::memory_order_release);
+				return true;
+			}
+		}
+		else if (diff < 0) {
+			return false;
+		}
+		else {
+			pos = m_dequeuePos.load(std::memory_order_relaxed);
+		}
+	}
+}
+
+template <typename T>
+size_t MPMCRingQueue<T>::DequeueBatch(std::vector<T>& out, size_t maxCount) {
+	size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+	size_t count;
+	for (;;) {
+		// count the published items in a row, then take them all at once
+		count = 0;
+		while (count < maxCount) {
+			size_t sequence = m_cells[(pos + count) & m_mask].m_sequence.load(std::memory_order_acquire);
+			if (sequence != pos + count + 1) {
+				break;
+			}
+			++count;
+		}
+		if (count == 0) {
+			return 0;
+		}
+		if (m_dequeuePos.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed)) {
+			break;
+		}
+	}
+
+	out.reserve(out.size() + count);
+	for (size_t itemIdx = 0; itemIdx < count; ++itemIdx) {
+		Cell_t& cell = m_cells[(pos + itemIdx) & m_mask];
+		T* item = cell.GetItem();
+		out.push_back(std::move(*item));
+		item->~T();
+		cell.m_sequence.store(pos + itemIdx + m_mask + 1, std::memory_order_release);
+	}
+	return count;
+}
+
+template <typename T>
+size_t MPMCRingQueue<T>::GetApproxSize() const {
+	size_t enqueuePos = m_enqueuePos.load(std::memory_order_relaxed);
+	size_t dequeuePos = m_dequeuePos.load(std::memory_order_relaxed);
+	return enqueuePos > dequeuePos ? enqueuePos - dequeuePos : 0;
+}
+
+//------------------------------------------------------------------------
+template <typename T>
+SPSCRingQueue<T>::SPSCRingQueue(size_t capacity) {
+	GUARANTEE_OR_DIE(capacity >= 2, "SPSCRingQueue - capacity must be at least 2!");
+	size_t numSlots = RoundUpToPowerOf2(capacity);
+	m_mask = numSlots - 1;
+	m_slots = new Slot_t[numSlots];
+}
+
+template <typename T>
+SPSCRingQueue<T>::~SPSCRingQueue() {
+	size_t pos = m_head.load(std::memory_order_relaxed);
+	size_t end = m_tail.load(std::memory_order_relaxed);
+	for (; pos != end; ++pos) {
+		GetItem(pos)->~T();
+	}
+	delete[] m_slots;
+}
+
+template <typename T>
+template <typename U>
+bool SPSCRingQueue<T>::Emplace(U&& v) {
+	size_t tail = m_tail.load(std::memory_order_relaxed);
+	if (tail - m_cachedHead > m_mask) {
+		m_cachedHead = m_head.load(std::memory_order_acquire);
+		if (tail - m_cachedHead > m_mask) {
+			return false;
+		}
+	}
+
+	new (GetItem(tail)) T(std::forward<U>(v));
+	m_tail.store(tail + 1, std::memory_order_release);
+	return true;
+}
+
+template <typename T>
+bool SPSCRingQueue<T>::TryDequeue(T& out) {
+	size_t head = m_head.load(std::memory_order_relaxed);
+	if (head == m_cachedTail) {
+		m_cachedTail = m_tail.load(std::memory_order_acquire);
+		if (head == m_cachedTail) {
+			return false;
+		}
+	}
+
+	T* item = GetItem(head);
+	out = std::move(*item);
+	item->~T();
+	m_head.store(head + 1, std::memory_order_release);
+	return true;
+}
+
+template <typename T>
+size_t SPSCRingQueue<T>::DequeueBatch(std::vector<T>& out, size_t maxCount) {
+	size_t head = m_head.load(std::memory_order_relaxed);
+	m_cachedTail = m_tail.load(std::memory_order_acquire);
+	size_t count = m_cachedTail - head;
+	if (count > maxCount) {
+		count = maxCount;
+	}
+	if (count == 0) {
+		return 0;
+	}
+
+	out.reserve(out.size() + count);
+	for (size_t itemIdx = 0; itemIdx < count; ++itemIdx) {
+		T* item = GetItem(head + itemIdx);
+		out.push_back(std::move(*item));
+		item->~T();
+	}
+	// hand all the slots back at once
+	m_head.store(head + count, std::memory_order_release);
+	return count;
+}
+
+template <typename T>
+size_t SPSCRingQueue<T>::GetApproxSize() const {
+	size_t tail = m_tail.load(std::memory_order_relaxed);
+	size_t head = m_head.load(std::memory_order_relaxed);
+	return tail > head ? tail - head : 0;
+}
@@ -1,37 +1,57 @@
 #include "Engine/Core/StackAllocator.hpp"
 #include "Engine/Core/ErrorWarningAssert.hpp"
 
-StackAllocator::StackAllocator(size_t totalSize) 
+StackAllocator::StackAllocator(size_t totalSize)
 	: m_totalSize(totalSize){
-	m_basePtr = AllocAligned(totalSize, 8);
-	m_topPtr = m_basePtr;
+	m_basePtr = (u8*)AllocAligned(totalSize, 8);
+#if defined(_DEBUG)
 	FillWithPattern(m_basePtr, totalSize, PATTERN_FREE);
+#endif
 }
 
 StackAllocator::~StackAllocator() {
 	FreeAligned(m_basePtr);
 	m_basePtr = nullptr;
-	m_topPtr = nullptr;
+	m_top = 0;
 }
 
 void* StackAllocator::Alloc(size_t size, size_t alignment) {
-	size_t currentAddress = (size_t)m_topPtr;
-	size_t alignedAddress = AlignAddress(currentAddress, alignment);
-	FillWithPattern(m_topPtr, alignedAddress - currentAddress, PATTERN_ALIGN);
-	m_topPtr = (void*)(alignedAddress + size);
-	FillWithPattern((void*)alignedAddress, size, PATTERN_ALLOC);
-	return (void*)alignedAddress;
+	size_t top = m_top.load(std::memory_order_relaxed);
+	size_t alignedTop;
+	size_t newTop;
+	do {
+		alignedTop = AlignAddress((size_t)m_basePtr + top, alignment) - (size_t)m_basePtr;
+		newTop = alignedTop + size;
+		if (newTop > m_totalSize) {
+			return nullptr;
+		}
+	} while (!m_top.compare_exchange_weak(top, newTop, std::memory_order_relaxed));
+
+#if defined(_DEBUG)
+	FillWithPattern(m_basePtr + top, alignedTop - top, PATTERN_ALIGN);
+	FillWithPattern(m_basePtr + alignedTop, size, PATTERN_ALLOC);
+#endif
+	return m_basePtr + alignedTop;
 }
 
 void StackAllocator::Free(void* ptr) {
-	if ((size_t)ptr >= (size_t)m_basePtr && (size_t)ptr <= (size_t)m_topPtr) {
-		m_topPtr = ptr;
-		FillWithPattern(m_topPtr, m_totalSize - (size_t)m_topPtr + (size_t)m_basePtr, PATTERN_FREE);
+	if ((u8*)ptr >= m_basePtr && (u8*)ptr <= m_basePtr + GetUsedSize()) {
+		FreeToMarker((u8*)ptr - m_basePtr);
 	}
 }
 
-void StackAllocator::Clear() {
-	m_topPtr = m_basePtr;
-	FillWithPattern(m_basePtr, m_totalSize, PATTERN_FREE);
+void StackAllocator::FreeToMarker(size_t marker) {
+	size_t top = m_top.load(std::memory_order_relaxed);
+	if (marker > top) {
+		DebuggerPrintf("StackAllocator::FreeToMarker - marker %zu is past the top %zu!\n", marker, top);
+		return;
+	}
+	m_top.store(marker, std::memory_order_relaxed);
+#if defined(_DEBUG)
+	FillWithPattern(m_basePtr + marker, top - marker, PATTERN_FREE);
+#endif
 }
 
+void StackAllocator::Clear() {
+	FreeToMarker(0);
+}
@@ -1,17 +1,44 @@
 #pragma once
 #include "Engine/Core/IAllocator.hpp"
+#include <atomic>
 
+// Linear allocator over one aligned block. Alloc only bumps an atomic offset, so several
+// threads may allocate at once; Free, FreeToMarker and Clear must not race with Alloc.
 class StackAllocator {
 public:
 	StackAllocator(size_t totalSize);
 	virtual ~StackAllocator();
+	StackAllocator(const StackAllocator&) = delete;
+	StackAllocator& operator=(const StackAllocator&) = delete;
 
-	void* Alloc(size_t size, size_t alignment = 8) ;
+	void* Alloc(size_t size, size_t alignment = 8);	// nullptr when it doesn't fit
 	void Free(void* ptr);  // will free all the way up to the top
-	void Clear() ;
+	void Clear();
+
+	// a marker is an offset from the base, freeing to it drops everything allocated after it
+	size_t GetMarker() const { return m_top.load(std::memory_order_relaxed); }
+	void FreeToMarker(size_t marker);
+
+	size_t GetUsedSize() const { return m_top.load(std::memory_order_relaxed); }
+	size_t GetTotalSize() const { return m_totalSize; }
+
+private:
+	size_t				m_totalSize = 0;
+	u8*					m_basePtr = nullptr;
+	std::atomic<size_t>	m_top{ 0 };
+};
+
+// Frees everything allocated from the stack inside the scope when it ends
+class StackAllocatorScope {
+public:
+	explicit StackAllocatorScope(StackAllocator& allocator)
+		: m_allocator(allocator)
+		, m_marker(allocator.GetMarker()) {}
+	~StackAllocatorScope() { m_allocator.FreeToMarker(m_marker); }
+	StackAllocatorScope(const StackAllocatorScope&) = delete;
+	StackAllocatorScope& operator=(const StackAllocatorScope&) = delete;
 
 private:
-	size_t  m_totalSize = 0;
-	void*	m_basePtr = nullptr;
-	void*	m_topPtr = nullptr;
+	StackAllocator&		m_allocator;
+	size_t				m_marker;
 };
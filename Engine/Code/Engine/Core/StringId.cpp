@@ -1,25 +1,100 @@
 #include "Engine/Core/StringId.hpp"
+#include "Engine/Core/ThreadSafeContainer.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include <cstring>
 #include <unordered_map>
+#include <vector>
 
-static std::unordered_map<std::string, StringId> g_theStringIdTable;
+// interned strings are packed in chunks this big, longer ones get a chunk of their own
+constexpr size_t STRING_ID_ARENA_CHUNK_SIZE = 64 * 1024;
 
-StringId CreateOrGetStringId(const std::string& str) {
-	StringId sid;
-	if (g_theStringIdTable.find(str) != g_theStringIdTable.end()) {
-		sid = g_theStringIdTable[str];
+namespace {
+class StringIdTable {
+public:
+	StringId CreateOrGet(const char* str, size_t length);
+	const char* Find(StringId sid);
+
+private:
+	const char* Intern(const char* str, size_t length);
+
+private:
+	ReadWriteLock							m_lock;
+	std::unordered_map<StringId, const char*>	m_strings;	// the id is the hash already
+	std::vector<char*>						m_chunks;			// everything allocated, never freed
+	char*									m_currentChunk = nullptr;	// where short strings go
+	size_t									m_chunkUsedSize = STRING_ID_ARENA_CHUNK_SIZE;
+};
+
+StringId StringIdTable::CreateOrGet(const char* str, size_t length) {
+	StringId sid = HashStringId(str, length);
+	{
+		ReadLockScope scope(m_lock);
+		auto it = m_strings.find(sid);
+		if (it != m_strings.end()) {
+#if defined(_DEBUG)
+			ASSERT_OR_DIE(strlen(it->second) == length && memcmp(it->second, str, length) == 0, "StringId - Hash collision, two strings share an id!");
+#endif
+			return sid;
+		}
 	}
+
+	WriteLockScope scope(m_lock);
+	// someone else may have added it in between
+	auto it = m_strings.find(sid);
+	if (it == m_strings.end()) {
+		m_strings.emplace(sid, Intern(str, length));
+	}
+#if defined(_DEBUG)
 	else {
-		sid = (unsigned int)std::hash<std::string>{}(str);
-		g_theStringIdTable[str] = sid;
+		ASSERT_OR_DIE(strlen(it->second) == length && memcmp(it->second, str, length) == 0, "StringId - Hash collision, two strings share an id!");
 	}
+#endif
 	return sid;
 }
 
-std::string GetStringFromSid(const StringId& sid) {
-	for (auto it : g_theStringIdTable) {
-		if (it.second == sid) {
-			return it.first;
+const char* StringIdTable::Find(StringId sid) {
+	ReadLockScope scope(m_lock);
+	auto it = m_strings.find(sid);
+	return it != m_strings.end() ? it->second : nullptr;
+}
+
+const char* StringIdTable::Intern(const char* str, size_t length) {
+	size_t size = length + 1;
+	char* copy;
+	if (size > STRING_ID_ARENA_CHUNK_SIZE) {
+		copy = new char[size];
+		m_chunks.push_back(copy);
+	}
+	else {
+		if (m_chunkUsedSize + size > STRING_ID_ARENA_CHUNK_SIZE) {
+			m_currentChunk = new char[STRING_ID_ARENA_CHUNK_SIZE];
+			m_chunks.push_back(m_currentChunk);
+			m_chunkUsedSize = 0;
 		}
+		// not m_chunks.back(), a long string may have been pushed after the current chunk
+		copy = m_currentChunk + m_chunkUsedSize;
+		m_chunkUsedSize += size;
 	}
-	return nullptr;
+	memcpy(copy, str, length);
+	copy[length] = '\0';
+	return copy;
+}
+
+// never destroyed, ids may be made during static init and looked up at exit
+StringIdTable& GetStringIdTable() {
+	static StringIdTable* s_table = new StringIdTable();
+	return *s_table;
+}
+}
+
+StringId CreateOrGetStringId(const char* str) {
+	return GetStringIdTable().CreateOrGet(str, strlen(str));
+}
+
+StringId CreateOrGetStringId(const std::string& str) {
+	return GetStringIdTable().CreateOrGet(str.c_str(), str.size());
+}
+
+const char* GetStringFromSid(StringId sid) {
+	return GetStringIdTable().Find(sid);
 }
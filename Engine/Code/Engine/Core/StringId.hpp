@@ -1,7 +1,39 @@
 #pragma once
 #include "Engine/Core/type.hpp"
 #include <string>
+#include <type_traits>
 typedef u32 StringId;
 
-extern StringId CreateOrGetStringId(const std::string& str);
-extern std::string GetStringFromSid(const StringId& sid);
\ No newline at end of file
+constexpr StringId INVALID_STRING_ID = 0;
+constexpr u32 FNV1A_32_OFFSET_BASIS = 2166136261u;
+constexpr u32 FNV1A_32_PRIME = 16777619u;
+
+// 32 bit FNV-1a, the same at compile time and at run time
+constexpr StringId HashStringId(const char* str) {
+	u32 hash = FNV1A_32_OFFSET_BASIS;
+	while (*str != '\0') {
+		hash ^= (u8)*str++;
+		hash *= FNV1A_32_PRIME;
+	}
+	return hash;
+}
+
+constexpr StringId HashStringId(const char* str, size_t length) {
+	u32 hash = FNV1A_32_OFFSET_BASIS;
+	for (size_t charIdx = 0; charIdx < length; ++charIdx) {
+		hash ^= (u8)str[charIdx];
+		hash *= FNV1A_32_PRIME;
+	}
+	return hash;
+}
+
+// Hashed at compile time, works as a case label. Not interned, so GetStringFromSid
+// only knows the string once something has gone through CreateOrGetStringId with it.
+#define SID(str) (std::integral_constant<StringId, HashStringId(str)>::value)
+
+// Interns the string, later calls with the same string only hash and look it up.
+// Thread safe. Two strings with the same hash assert in debug.
+StringId CreateOrGetStringId(const char* str);
+StringId CreateOrGetStringId(const std::string& str);
+// nullptr if the id was never interned, the string lives as long as the program
+const char* GetStringFromSid(StringId sid);
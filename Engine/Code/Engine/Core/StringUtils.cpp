@@ -39,3 +39,45 @@ const std::string Stringf( const int maxLength, const char* format, ... )
 }
 
 
+//-----------------------------------------------------------------------------------------------
+std::string GetJsonEscapedString(const std::string& text) {
+	std::string escaped;
+	escaped.reserve(text.size());
+	for (char c : text) {
+		switch (c) {
+		case '"':	escaped += "\\\"";	break;
+		case '\\':	escaped += "\\\\";	break;
+		case '\b':	escaped += "\\b";	break;
+		case '\f':	escaped += "\\f";	break;
+		case '\n':	escaped += "\\n";	break;
+		case '\r':	escaped += "\\r";	break;
+		case '\t':	escaped += "\\t";	break;
+		default:
+			// JSON allows no raw control characters in a string
+			if ((unsigned char)c < 0x20) {
+				escaped += Stringf("\\u%04x", (unsigned int)(unsigned char)c);
+			}
+			else {
+				escaped += c;
+			}
+			break;
+		}
+	}
+	return escaped;
+}
+
+std::string GetCSVEscapedString(const std::string& text) {
+	if (text.find_first_of(",\"\r\n") == std::string::npos) {
+		return text;
+	}
+
+	std::string escaped = "\"";
+	for (char c : text) {
+		if (c == '"') {
+			escaped += '"';
+		}
+		escaped += c;
+	}
+	escaped += '"';
+	return escaped;
+}
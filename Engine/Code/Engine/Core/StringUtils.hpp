@@ -8,6 +8,11 @@ constexpr int STRINGF_STACK_LOCAL_TEMP_LENGTH = 2048;
 const std::string Stringf( const char* format, ... );
 const std::string Stringf( const int maxLength, const char* format, ... );
 
+// quotes, backslashes and control characters escaped, for a JSON string
+std::string GetJsonEscapedString(const std::string& text);
+// quoted if it has a comma, quote or line break, for a CSV field
+std::string GetCSVEscapedString(const std::string& text);
+
 //Exception: boolean
 template <class T>
 bool ParseFromString(T& out, const std::string& str) {
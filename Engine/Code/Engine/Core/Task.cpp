@@ -0,0 +1,66 @@
+#include "Engine/Core/Task.hpp"
+#include <fstream>
+
+#if !defined(__cpp_impl_coroutine)
+namespace {
+// loops on a suspend forever, each thread has its own so resuming it never races
+struct NoopCoroutine {
+	struct promise_type {
+		NoopCoroutine get_return_object() { return NoopCoroutine{ coro::coroutine_handle<promise_type>::from_promise(*this) }; }
+		coro::suspend_always initial_suspend() noexcept { return {}; }
+		coro::suspend_always final_suspend() noexcept { return {}; }
+		void return_void() {}
+		void unhandled_exception() { std::terminate(); }
+	};
+
+	coro::coroutine_handle<promise_type> m_handle;
+};
+
+NoopCoroutine RunNoop() {
+	for (;;) {
+		co_await coro::suspend_always{};
+	}
+}
+
+struct ThreadNoopCoroutine {
+	~ThreadNoopCoroutine() { m_handle.destroy(); }
+
+	coro::coroutine_handle<NoopCoroutine::promise_type> m_handle = RunNoop().m_handle;
+};
+}
+#endif
+
+coro::coroutine_handle<> GetNoopCoroutine() {
+#if defined(__cpp_impl_coroutine)
+	return coro::noop_coroutine();
+#else
+	// the coroutines TS header has no noop_coroutine
+	thread_local ThreadNoopCoroutine s_noopCoroutine;
+	return s_noopCoroutine.m_handle;
+#endif
+}
+
+//------------------------------------------------------------------------
+void ResumeOnWorker::await_suspend(coro::coroutine_handle<> handle) const {
+	g_theJobSystem->QueueJob(std::make_unique<CoroutineResumeJob>(handle, m_channels));
+}
+
+void ResumeOnMainThread::await_suspend(coro::coroutine_handle<> handle) const {
+	g_theJobSystem->QueueMainThreadJob(std::make_unique<CoroutineResumeJob>(handle));
+}
+
+//------------------------------------------------------------------------
+Task<std::vector<char>> ReadFileAsync(std::string filePath) {
+	co_await ResumeOnWorker(JOB_CHANNEL_MASK_IO);
+
+	std::vector<char> buffer;
+	std::ifstream is(filePath, std::ifstream::binary);
+	if (is) {
+		is.seekg(0, is.end);
+		size_t length = (size_t)is.tellg();
+		is.seekg(0, is.beg);
+		buffer.resize(length);
+		is.read(buffer.data(), length);
+	}
+	co_return buffer;
+}
@@ -0,0 +1,205 @@
+#pragma once
+#include "Engine/Core/type.hpp"
+#include "Engine/Core/JobSystem.hpp"
+#include <atomic>
+#include <exception>
+#include <string>
+#include <utility>
+#include <vector>
+
+// v141 only has the coroutines TS (/await), newer toolsets have the standard header
+#if defined(__cpp_impl_coroutine)
+#include <coroutine>
+namespace coro = std;
+#else
+#include <experimental/coroutine>
+namespace coro = std::experimental;
+#endif
+
+// Coroutine tasks on top of the JobSystem.
+// A Task is lazy: its body starts when it is awaited or Start()ed, and it runs on whatever
+// thread resumes it. co_await ResumeOnWorker() / ResumeOnMainThread() hops between threads.
+//
+//	Task<void> LoadThing(std::string path) {
+//		std::vector<char> data = co_await ReadFileAsync(path);	// file read on a worker
+//		co_await ResumeOnMainThread();							// back on the main thread
+//		...
+//	}
+//
+// Coroutines take their parameters by value, references would dangle once the caller returns.
+
+// resuming it does nothing, for symmetric transfers that have nothing to go on with
+coro::coroutine_handle<> GetNoopCoroutine();
+
+class TaskPromiseBase {
+public:
+	// flags the task done and hands the thread to whoever awaited it
+	struct FinalAwaiter {
+		bool await_ready() const noexcept { return false; }
+		coro::coroutine_handle<> await_suspend(coro::coroutine_handle<>) const noexcept {
+			// the owner may destroy the frame as soon as it sees the flag, don't touch it after
+			coro::coroutine_handle<> continuation = m_promise->m_continuation;
+			m_promise->m_isDone.store(true, std::memory_order_release);
+			// returned instead of resumed, so a chain of awaits doesn't grow the stack
+			return continuation ? continuation : GetNoopCoroutine();
+		}
+		void await_resume() const noexcept {}
+
+		TaskPromiseBase* m_promise;
+	};
+
+	coro::suspend_always initial_suspend() noexcept { return {}; }
+	FinalAwaiter final_suspend() noexcept { return FinalAwaiter{ this }; }
+	void unhandled_exception() { std::terminate(); } // no exceptions in the engine
+
+	bool IsDone() const { return m_isDone.load(std::memory_order_acquire); }
+
+public:
+	coro::coroutine_handle<>	m_continuation;
+	std::atomic<bool>			m_isDone{ false };
+};
+
+template <typename T>
+class Task {
+public:
+	class promise_type : public TaskPromiseBase {
+	public:
+		Task get_return_object() { return Task(coro::coroutine_handle<promise_type>::from_promise(*this)); }
+		void return_value(T value) { m_value = std::move(value); }
+
+	public:
+		T m_value;
+	};
+
+	Task() = default;
+	Task(Task&& other) : m_handle(other.m_handle) { other.m_handle = nullptr; }
+	Task& operator=(Task&& other) {
+		if (this != &other) {
+			Destroy();
+			m_handle = other.m_handle;
+			other.m_handle = nullptr;
+		}
+		return *this;
+	}
+	Task(const Task&) = delete;
+	Task& operator=(const Task&) = delete;
+	~Task() { Destroy(); }
+
+	bool IsValid() const { return (bool)m_handle; }
+	bool IsReady() const { return !m_handle || m_handle.promise().IsDone(); }
+
+	// runs the body until its first suspension, the task has to stay alive until IsReady()
+	void Start() { m_handle.resume(); }
+
+	// awaiting starts the task and continues the awaiting coroutine when it's done
+	bool await_ready() const { return IsReady(); }
+	coro::coroutine_handle<> await_suspend(coro::coroutine_handle<> awaiting) {
+		m_handle.promise().m_continuation = awaiting;
+		return m_handle;
+	}
+	T await_resume() { return std::move(m_handle.promise().m_value); }
+
+private:
+	explicit Task(coro::coroutine_handle<promise_type> handle) : m_handle(handle) {}
+	void Destroy() {
+		if (m_handle) {
+			m_handle.destroy();
+			m_handle = nullptr;
+		}
+	}
+
+private:
+	coro::coroutine_handle<promise_type> m_handle;
+};
+
+template <>
+class Task<void> {
+public:
+	class promise_type : public TaskPromiseBase {
+	public:
+		Task get_return_object() { return Task(coro::coroutine_handle<promise_type>::from_promise(*this)); }
+		void return_void() {}
+	};
+
+	Task() = default;
+	Task(Task&& other) : m_handle(other.m_handle) { other.m_handle = nullptr; }
+	Task& operator=(Task&& other) {
+		if (this != &other) {
+			Destroy();
+			m_handle = other.m_handle;
+			other.m_handle = nullptr;
+		}
+		return *this;
+	}
+	Task(const Task&) = delete;
+	Task& operator=(const Task&) = delete;
+	~Task() { Destroy(); }
+
+	bool IsValid() const { return (bool)m_handle; }
+	bool IsReady() const { return !m_handle || m_handle.promise().IsDone(); }
+	void Start() { m_handle.resume(); }
+
+	bool await_ready() const { return IsReady(); }
+	coro::coroutine_handle<> await_suspend(coro::coroutine_handle<> awaiting) {
+		m_handle.promise().m_continuation = awaiting;
+		return m_handle;
+	}
+	void await_resume() {}
+
+private:
+	explicit Task(coro::coroutine_handle<promise_type> handle) : m_handle(handle) {}
+	void Destroy() {
+		if (m_handle) {
+			m_handle.destroy();
+			m_handle = nullptr;
+		}
+	}
+
+private:
+	coro::coroutine_handle<promise_type> m_handle;
+};
+
+//------------------------------------------------------------------------
+// Awaitables
+
+// Resumes a suspended coroutine from inside a job
+class CoroutineResumeJob : public Job {
+public:
+	CoroutineResumeJob(coro::coroutine_handle<> handle, u32 channels = JOB_CHANNEL_MASK_WORKERS)
+		: Job(channels), m_handle(handle) {
+		m_isCompleteCallbackEnabled = false;
+	}
+	virtual void Execute() override { m_handle.resume(); }
+	virtual void JobCompleteCallback() override {}
+
+private:
+	coro::coroutine_handle<> m_handle;
+};
+
+// co_await ResumeOnWorker() continues the coroutine on a job worker
+class ResumeOnWorker {
+public:
+	explicit ResumeOnWorker(u32 channels = JOB_CHANNEL_MASK_WORKERS) : m_channels(channels) {}
+
+	bool await_ready() const { return false; }
+	void await_suspend(coro::coroutine_handle<> handle) const;
+	void await_resume() const {}
+
+private:
+	u32 m_channels = JOB_CHANNEL_MASK_WORKERS;
+};
+
+// co_await ResumeOnMainThread() continues the coroutine in the next FinishAllCompletedJobs,
+// or right away if it's already on the main thread
+class ResumeOnMainThread {
+public:
+	bool await_ready() const { return g_theJobSystem->IsMainThread(); }
+	void await_suspend(coro::coroutine_handle<> handle) const;
+	void await_resume() const {}
+};
+
+//------------------------------------------------------------------------
+// File IO, runs on a JOB_CHANNEL_IO worker and resumes the awaiting coroutine there
+
+// empty if the file can't be opened
+Task<std::vector<char>> ReadFileAsync(std::string filePath);
@@ -1,11 +1,27 @@
 #include "Engine/Core/Thread.hpp"
 #include "Engine/Core/ErrorWarningAssert.hpp"
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <Windows.h>
 
 ThreadManager g_theThreadManager;
 
+ThreadManager::~ThreadManager() {
+	JoinAll();
+}
+
 void ThreadManager::Join(threadHandle handle) {
-	if (handle >= 0 && m_threads[handle]->joinable()) {
-		m_threads[handle]->join();
+	// take the thread out of its slot first, the slot is free again once we return
+	std::unique_ptr<std::thread> thread;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (handle >= 0 && handle < (threadHandle)m_threads.size() && m_threads[handle] && m_threads[handle]->joinable()) {
+			thread = std::move(m_threads[handle]);
+		}
+	}
+	if (thread) {
+		thread->join();
 	}
 	else {
 		DebuggerPrintf("ThreadHandle is invalid!\n");
@@ -13,8 +29,10 @@ void ThreadManager::Join(threadHandle handle) {
 }
 
 void ThreadManager::Detach(threadHandle handle) {
-	if (handle >= 0 && m_threads[handle]->joinable()) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (handle >= 0 && handle < (threadHandle)m_threads.size() && m_threads[handle] && m_threads[handle]->joinable()) {
 		m_threads[handle]->detach();
+		m_threads[handle].reset();
 	}
 	else {
 		DebuggerPrintf("ThreadHandle is invalid!\n");
@@ -22,11 +40,140 @@ void ThreadManager::Detach(threadHandle handle) {
 }
 
 bool ThreadManager::IsRunning(threadHandle handle) {
-	if (handle >= 0) {
-		return m_threads[handle]->joinable();
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (handle >= 0 && handle < (threadHandle)m_threads.size()) {
+		return m_threads[handle] && m_threads[handle]->joinable();
 	}
 	else {
 		DebuggerPrintf("ThreadHandle is invalid!\n");
 		return false;
 	}
 }
+
+void ThreadManager::JoinAll() {
+	std::vector<std::unique_ptr<std::thread>> threads;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		for (auto& thread : m_threads) {
+			if (thread && thread->joinable()) {
+				threads.push_back(std::move(thread));
+			}
+		}
+	}
+	for (auto& thread : threads) {
+		thread->join();
+	}
+}
+
+std::string ThreadManager::GetThreadName(threadHandle handle) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (handle >= 0 && handle < (threadHandle)m_threadNames.size()) {
+		return m_threadNames[handle];
+	}
+	return "";
+}
+
+int ThreadManager::GetHardwareThreadCount() {
+	// every processor group, hardware_concurrency only counts the one we started in (64 at most)
+	int count = (int)::GetActiveProcessorCount(ALL_PROCESSOR_GROUPS);
+	if (count <= 0) {
+		count = (int)std::thread::hardware_concurrency();
+	}
+	return count > 0 ? count : 1;
+}
+
+int ThreadManager::GetRecommendedWorkerCount() {
+	int count = GetHardwareThreadCount() - 1;
+	return count > 0 ? count : 1;
+}
+
+threadHandle ThreadManager::FindFreeSlot() {
+	for (size_t slotIdx = 0; slotIdx < m_threads.size(); ++slotIdx) {
+		if (m_threads[slotIdx] == nullptr || !m_threads[slotIdx]->joinable()) {
+			return (threadHandle)slotIdx;
+		}
+	}
+	m_threads.emplace_back();
+	m_threadNames.emplace_back();
+	return (threadHandle)(m_threads.size() - 1);
+}
+
+//------------------------------------------------------------------------
+// SetThreadDescription only exists since Windows 10 1607, look it up instead of linking it
+typedef HRESULT(WINAPI *SetThreadDescription_t)(HANDLE, PCWSTR);
+
+static void SetNativeThreadName(HANDLE thread, const std::string& name) {
+	static SetThreadDescription_t s_setThreadDescription = (SetThreadDescription_t)::GetProcAddress(::GetModuleHandleW(L"kernel32.dll"), "SetThreadDescription");
+	if (s_setThreadDescription && !name.empty()) {
+		std::wstring wideName(name.begin(), name.end());
+		s_setThreadDescription(thread, wideName.c_str());
+	}
+}
+
+static thread_local std::string s_currentThreadName;
+
+void ThreadManager::SetCurrentThreadName(const std::string& name) {
+	s_currentThreadName = name;
+	SetNativeThreadName(::GetCurrentThread(), name);
+}
+
+std::string ThreadManager::GetCurrentThreadName() {
+	if (!s_currentThreadName.empty()) {
+		return s_currentThreadName;
+	}
+
+	// a thread of ours, named when it was created
+	std::lock_guard<std::mutex> lock(m_mutex);
+	std::thread::id threadId = std::this_thread::get_id();
+	for (size_t threadIdx = 0; threadIdx < m_threads.size(); ++threadIdx) {
+		if (m_threads[threadIdx] && m_threads[threadIdx]->get_id() == threadId) {
+			return m_threadNames[threadIdx];
+		}
+	}
+	return std::string();
+}
+
+// core index over all processor groups to the group it's in and its bit there
+static bool GetGroupAffinity(int coreIdx, GROUP_AFFINITY& outAffinity) {
+	WORD groupCount = ::GetActiveProcessorGroupCount();
+	for (WORD groupIdx = 0; groupIdx < groupCount; ++groupIdx) {
+		int groupSize = (int)::GetActiveProcessorCount(groupIdx);
+		if (coreIdx < groupSize) {
+			// KAFFINITY is 32 bits on Win32
+			if (coreIdx >= (int)(sizeof(KAFFINITY) * 8)) {
+				return false;
+			}
+			outAffinity = GROUP_AFFINITY();	// the reserved words have to be zero
+			outAffinity.Group = groupIdx;
+			outAffinity.Mask = (KAFFINITY)1 << coreIdx;
+			return true;
+		}
+		coreIdx -= groupSize;
+	}
+	return false;
+}
+
+void ThreadManager::ApplyThreadDesc(std::thread& thread, const ThreadDesc_t& desc) {
+	HANDLE nativeHandle = (HANDLE)thread.native_handle();
+	SetNativeThreadName(nativeHandle, desc.m_name);
+
+	if (desc.m_coreIdx >= 0) {
+		GROUP_AFFINITY affinity;
+		if (GetGroupAffinity(desc.m_coreIdx, affinity)) {
+			::SetThreadGroupAffinity(nativeHandle, &affinity, nullptr);
+		}
+		else {
+			DebuggerPrintf("Thread %s: can't pin it to core %d, leaving it to the OS.\n", desc.m_name.c_str(), desc.m_coreIdx);
+		}
+	}
+
+	static const int s_priorities[NUM_THREAD_PRIOS] = {
+		THREAD_PRIORITY_BELOW_NORMAL,
+		THREAD_PRIORITY_NORMAL,
+		THREAD_PRIORITY_ABOVE_NORMAL,
+		THREAD_PRIORITY_TIME_CRITICAL
+	};
+	if (desc.m_priority != THREAD_PRIO_NORMAL) {
+		::SetThreadPriority(nativeHandle, s_priorities[desc.m_priority]);
+	}
+}
@@ -2,34 +2,72 @@
 #include "Engine/Core/type.hpp"
 #include <thread>
 #include <memory>
+#include <mutex>
+#include <string>
 #include <vector>
 #include <future>
 #include <chrono>
+#include <type_traits>
 
-constexpr int MAX_THREADS = 16;
+enum eThreadPriority {
+	THREAD_PRIO_LOW = 0,
+	THREAD_PRIO_NORMAL,
+	THREAD_PRIO_HIGH,
+	THREAD_PRIO_CRITICAL,
+	NUM_THREAD_PRIOS
+};
+
+// Hints for a new thread, applied by the OS where it supports them
+struct ThreadDesc_t {
+	std::string		m_name;							// shows up in the debugger and profilers
+	int				m_coreIdx = -1;					// pins the thread to one core, counted over all processor groups. -1 lets the OS schedule it anywhere
+	eThreadPriority	m_priority = THREAD_PRIO_NORMAL;
+};
 
+// Owns every engine thread. Slots grow on demand and are reused once their thread
+// was joined or detached, so handles are small indices.
+// Threads still running at shutdown are joined, never left dangling.
 class ThreadManager {
 public:
 	ThreadManager() = default;
-	~ThreadManager() = default;
+	~ThreadManager();
 
-	template <typename Func, typename... Args>
+	// a ThreadDesc_t first always goes to the overload below, whether it's const or not
+	template <typename Func, typename... Args, typename = std::enable_if_t<!std::is_same<std::decay_t<Func>, ThreadDesc_t>::value>>
 	threadHandle CreateThread(Func&& f, Args&&... args) {
-		for (uint i = 0; i < MAX_THREADS; ++i) {
-			if (m_threads[i] == nullptr || !IsRunning(i)) {
-				m_threads[i] = std::make_unique<std::thread>(std::forward<Func>(f), std::forward<Args>(args)...);
-				return (threadHandle)i;
-			}
-		}
-		return -1;
+		return CreateThread(ThreadDesc_t(), std::forward<Func>(f), std::forward<Args>(args)...);
+	}
+
+	template <typename Func, typename... Args>
+	threadHandle CreateThread(const ThreadDesc_t& desc, Func&& f, Args&&... args) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		threadHandle handle = FindFreeSlot();
+		m_threads[handle] = std::make_unique<std::thread>(std::forward<Func>(f), std::forward<Args>(args)...);
+		m_threadNames[handle] = desc.m_name;
+		ApplyThreadDesc(*m_threads[handle], desc);
+		return handle;
 	}
 
 	void Join(threadHandle handle);
 	void Detach(threadHandle handle);
 	bool IsRunning(threadHandle handle);
+	void JoinAll();
+	std::string GetThreadName(threadHandle handle);
+	// the name given by SetCurrentThreadName or the ThreadDesc_t, empty if there is none
+	std::string GetCurrentThreadName();
+
+	static int GetHardwareThreadCount();
+	static int GetRecommendedWorkerCount(); // one per hardware thread, minus the main thread
+	static void SetCurrentThreadName(const std::string& name);
+
+private:
+	threadHandle FindFreeSlot();
+	static void ApplyThreadDesc(std::thread& thread, const ThreadDesc_t& desc);
 
 private:
-	std::unique_ptr<std::thread> m_threads[MAX_THREADS];
+	std::mutex									m_mutex;
+	std::vector<std::unique_ptr<std::thread>>	m_threads;
+	std::vector<std::string>					m_threadNames;
 };
 
 extern ThreadManager g_theThreadManager;
@@ -1,83 +1,289 @@
 #pragma once
-#include <mutex>
-#include <queue>
-#include <set>
+#include "Engine/Core/type.hpp"
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <intrin.h>
 
+constexpr size_t CACHE_LINE_SIZE = 64;
+
+// pauses a spinning thread twice as long every round, then starts giving its core away
+class SpinBackoff {
+public:
+	void Pause() {
+		if (m_numPauses <= MAX_PAUSES) {
+			for (u32 pauseIdx = 0; pauseIdx < m_numPauses; ++pauseIdx) {
+				_mm_pause();
+			}
+			m_numPauses <<= 1;
+		}
+		else {
+			std::this_thread::yield();
+		}
+	}
+
+private:
+	static constexpr u32 MAX_PAUSES = 64;
+	u32 m_numPauses = 1;
+};
+
+// Test and test and set, waiters spin on a plain load so the cache line stays shared
+// until the owner lets go. For short critical sections only.
 class SpinLock {
 public:
-	void Enter() { m_lock.lock(); } // blocking operation
-	bool TryEnter() { return m_lock.try_lock(); }
-	void Exit() { m_lock.unlock(); } // must be called if entered
+	void Enter() { // blocking operation
+		SpinBackoff backoff;
+		while (m_isLocked.exchange(true, std::memory_order_acquire)) {
+			while (m_isLocked.load(std::memory_order_relaxed)) {
+				backoff.Pause();
+			}
+		}
+	}
+	bool TryEnter() { return !m_isLocked.load(std::memory_order_relaxed) && !m_isLocked.exchange(true, std::memory_order_acquire); }
+	void Exit() { m_isLocked.store(false, std::memory_order_release); } // must be called if entered
+
+private:
+	std::atomic<bool> m_isLocked{ false };
+};
+
+// Spinning reader writer lock for read mostly tables. Any number of readers or one writer,
+// a waiting writer keeps new readers out so it can't starve. Not recursive.
+class ReadWriteLock {
+public:
+	void EnterRead() {
+		SpinBackoff backoff;
+		for (;;) {
+			u32 state = m_state.load(std::memory_order_relaxed);
+			if ((state & (WRITER_BIT | WRITER_WAITING_BIT)) == 0
+				&& m_state.compare_exchange_weak(state, state + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+				return;
+			}
+			backoff.Pause();
+		}
+	}
+	void ExitRead() { m_state.fetch_sub(1, std::memory_order_release); }
+
+	void EnterWrite() {
+		SpinBackoff backoff;
+		for (;;) {
+			u32 state = m_state.load(std::memory_order_relaxed);
+			// no readers left and nobody writing, the waiting bit may be ours or another writer's
+			if ((state & ~WRITER_WAITING_BIT) == 0
+				&& m_state.compare_exchange_weak(state, WRITER_BIT, std::memory_order_acquire, std::memory_order_relaxed)) {
+				return;
+			}
+			if ((state & WRITER_WAITING_BIT) == 0) {
+				m_state.fetch_or(WRITER_WAITING_BIT, std::memory_order_relaxed);
+			}
+			backoff.Pause();
+		}
+	}
+	void ExitWrite() { m_state.fetch_and(~WRITER_BIT, std::memory_order_release); }
 
+private:
+	static constexpr u32 WRITER_BIT = 1u << 31;
+	static constexpr u32 WRITER_WAITING_BIT = 1u << 30;
+	// reader count in the low bits
+	std::atomic<u32> m_state{ 0 };
+};
+
+class SpinLockScope {
+public:
+	explicit SpinLockScope(SpinLock& lock) : m_lock(lock) { m_lock.Enter(); }
+	~SpinLockScope() { m_lock.Exit(); }
+	SpinLockScope(const SpinLockScope&) = delete;
+	SpinLockScope& operator=(const SpinLockScope&) = delete;
+
+private:
+	SpinLock& m_lock;
+};
+
+class ReadLockScope {
 public:
-	std::mutex m_lock;
+	explicit ReadLockScope(ReadWriteLock& lock) : m_lock(lock) { m_lock.EnterRead(); }
+	~ReadLockScope() { m_lock.ExitRead(); }
+	ReadLockScope(const ReadLockScope&) = delete;
+	ReadLockScope& operator=(const ReadLockScope&) = delete;
+
+private:
+	ReadWriteLock& m_lock;
 };
 
-template <typename T>
-class ThreadSafeQueue {
+class WriteLockScope {
 public:
-	void Enqueue(T&& v) noexcept {
-		m_lock.Enter();
+	explicit WriteLockScope(ReadWriteLock& lock) : m_lock(lock) { m_lock.EnterWrite(); }
+	~WriteLockScope() { m_lock.ExitWrite(); }
+	WriteLockScope(const WriteLockScope&) = delete;
+	WriteLockScope& operator=(const WriteLockScope&) = delete;
+
+private:
+	ReadWriteLock& m_lock;
+};
+
+// Shard a key lands in. The hash is mixed first, std::hash of an int is the int itself.
+inline size_t GetShardIndex(size_t hash, size_t numShards) {
+	hash ^= hash >> 17;
+	hash *= 0xed5ad4bbU;
+	hash ^= hash >> 11;
+	return hash & (numShards - 1);
+}
 
-		// I AM THE ONLY PERSON HERE
-		m_data.emplace(v);
+// Hash set split into NUM_SHARDS independently locked tables (lock striping).
+// Threads only contend when their keys land in the same shard, and lookups only take a read lock.
+template <typename K, typename Hash = std::hash<K>, size_t NUM_SHARDS = 16>
+class ConcurrentHashSet {
+	static_assert((NUM_SHARDS & (NUM_SHARDS - 1)) == 0, "ConcurrentHashSet - NUM_SHARDS must be a power of 2!");
+public:
+	bool Insert(const K& key) { // false if it was already there
+		Shard_t& shard = GetShard(key);
+		WriteLockScope scope(shard.m_lock);
+		return shard.m_data.insert(key).second;
+	}
 
-		m_lock.Exit();
-		// no longer true...
+	bool Erase(const K& key) {
+		Shard_t& shard = GetShard(key);
+		WriteLockScope scope(shard.m_lock);
+		return shard.m_data.erase(key) > 0;
 	}
 
-	// return if it succeeds
-	bool Dequeue(T& out) {
-		m_lock.Enter();
+	bool Contains(const K& key) const {
+		const Shard_t& shard = GetShard(key);
+		ReadLockScope scope(shard.m_lock);
+		return shard.m_data.find(key) != shard.m_data.end();
+	}
 
-		bool hasItem = !m_data.empty();
-		if (hasItem) {
-			out = std::move(m_data.front());
-			m_data.pop();
+	// shard by shard, not an atomic snapshot of the whole set
+	void Clear() {
+		for (Shard_t& shard : m_shards) {
+			WriteLockScope scope(shard.m_lock);
+			shard.m_data.clear();
 		}
+	}
 
-		m_lock.Exit();
-		return hasItem;
+	size_t GetSize() const {
+		size_t size = 0;
+		for (const Shard_t& shard : m_shards) {
+			ReadLockScope scope(shard.m_lock);
+			size += shard.m_data.size();
+		}
+		return size;
 	}
 
-public:
-	std::queue<T> m_data;
-	SpinLock m_lock;
+private:
+	struct Shard_t {
+		mutable ReadWriteLock				m_lock;
+		std::unordered_set<K, Hash>			m_data;
+		char								m_pad[CACHE_LINE_SIZE];	// keeps the locks of two shards off one cache line
+	};
+
+	Shard_t& GetShard(const K& key) { return m_shards[GetShardIndex(Hash{}(key), NUM_SHARDS)]; }
+	const Shard_t& GetShard(const K& key) const { return m_shards[GetShardIndex(Hash{}(key), NUM_SHARDS)]; }
+
+private:
+	Shard_t m_shards[NUM_SHARDS];
 };
 
-template <typename T>
-class ThreadSafeSet {
+// Hash map split into NUM_SHARDS independently locked tables, see ConcurrentHashSet.
+// Values are never handed out by reference, read them with Find (copy) or Visit (under the shard's read lock).
+template <typename K, typename V, typename Hash = std::hash<K>, size_t NUM_SHARDS = 16>
+class ConcurrentHashMap {
+	static_assert((NUM_SHARDS & (NUM_SHARDS - 1)) == 0, "ConcurrentHashMap - NUM_SHARDS must be a power of 2!");
 public:
-	void Insert(const T& v) noexcept {
-		m_lock.Enter();
-		m_data.emplace(v);
-		m_lock.Exit();
+	// value is only moved from if the key wasn't there yet
+	template <typename U>
+	bool Insert(const K& key, U&& value) {
+		Shard_t& shard = GetShard(key);
+		WriteLockScope scope(shard.m_lock);
+		if (shard.m_data.find(key) != shard.m_data.end()) {
+			return false;
+		}
+		shard.m_data.emplace(key, std::forward<U>(value));
+		return true;
 	}
 
-	void Erase(const T& e) {
-		m_lock.Enter();
-		for (auto& it : m_data) {
-			if (it == e) {
-				m_data.erase(it);
-			}
+	template <typename U>
+	void InsertOrAssign(const K& key, U&& value) {
+		Shard_t& shard = GetShard(key);
+		WriteLockScope scope(shard.m_lock);
+		shard.m_data[key] = std::forward<U>(value);
+	}
+
+	bool Erase(const K& key) {
+		Shard_t& shard = GetShard(key);
+		WriteLockScope scope(shard.m_lock);
+		return shard.m_data.erase(key) > 0;
+	}
+
+	bool Contains(const K& key) const {
+		const Shard_t& shard = GetShard(key);
+		ReadLockScope scope(shard.m_lock);
+		return shard.m_data.find(key) != shard.m_data.end();
+	}
+
+	bool Find(const K& key, V& out) const {
+		const Shard_t& shard = GetShard(key);
+		ReadLockScope scope(shard.m_lock);
+		auto it = shard.m_data.find(key);
+		if (it == shard.m_data.end()) {
+			return false;
+		}
+		out = it->second;
+		return true;
+	}
+
+	// calls fn(const V&) if the key is there, keep fn short, the shard is locked meanwhile
+	template <typename Fn>
+	bool Visit(const K& key, Fn&& fn) const {
+		const Shard_t& shard = GetShard(key);
+		ReadLockScope scope(shard.m_lock);
+		auto it = shard.m_data.find(key);
+		if (it == shard.m_data.end()) {
+			return false;
 		}
-		m_lock.Exit();
+		fn(it->second);
+		return true;
 	}
 
-	bool Find(const T& e) {
-		m_lock.Enter();
-		bool hasFound = m_data.find(e) != m_data.end();
-		m_lock.Exit();
-		return hasFound;
+	// calls fn(const K&, const V&) for every entry, shard by shard
+	template <typename Fn>
+	void ForEach(Fn&& fn) const {
+		for (const Shard_t& shard : m_shards) {
+			ReadLockScope scope(shard.m_lock);
+			for (auto& it : shard.m_data) {
+				fn(it.first, it.second);
+			}
+		}
 	}
 
 	void Clear() {
-		m_lock.Enter();
-		m_data.clear();
-		m_lock.Exit();
+		for (Shard_t& shard : m_shards) {
+			WriteLockScope scope(shard.m_lock);
+			shard.m_data.clear();
+		}
 	}
 
-public:
-	std::set<T> m_data;
-	SpinLock m_lock;
-};
\ No newline at end of file
+	size_t GetSize() const {
+		size_t size = 0;
+		for (const Shard_t& shard : m_shards) {
+			ReadLockScope scope(shard.m_lock);
+			size += shard.m_data.size();
+		}
+		return size;
+	}
+
+private:
+	struct Shard_t {
+		mutable ReadWriteLock				m_lock;
+		std::unordered_map<K, V, Hash>		m_data;
+		char								m_pad[CACHE_LINE_SIZE];
+	};
+
+	Shard_t& GetShard(const K& key) { return m_shards[GetShardIndex(Hash{}(key), NUM_SHARDS)]; }
+	const Shard_t& GetShard(const K& key) const { return m_shards[GetShardIndex(Hash{}(key), NUM_SHARDS)]; }
+
+private:
+	Shard_t m_shards[NUM_SHARDS];
+};
@@ -1,6 +1,7 @@
 #include "Engine/Core/Time.hpp"
 #include "Engine/Core/StringUtils.hpp"
 #include "Engine/Math/MathUtils.hpp"
+#include <chrono>
 #include <ctime>
 
 static LocalTimeData g_localTimeData;
@@ -47,12 +48,27 @@ std::string GetTimeString(double seconds) {
 	return Stringf("%d us", (int)seconds);
 }
 
-std::string GetTimestamp() {
-	time_t rawtime;
+static std::string GetTimestampString(time_t rawtime) {
 	char buffer[100];
-	time(&rawtime);
 	struct tm timeinfo;
 	localtime_s(&timeinfo, &rawtime);
 	strftime(buffer, sizeof(buffer), "%Y%m%d_%H%M%S", &timeinfo);
 	return std::string(buffer);
 }
+
+std::string GetTimestamp() {
+	time_t rawtime;
+	time(&rawtime);
+	return GetTimestampString(rawtime);
+}
+
+std::string GetTimestamp(u64 hpc) {
+	// the wall clock and the counter read once, together; after that the counter says how far from there
+	static const std::chrono::system_clock::time_point s_anchorTime = std::chrono::system_clock::now();
+	static const u64 s_anchorHPC = GetPerformanceCounter();
+
+	double secondsFromAnchor = hpc >= s_anchorHPC ? PerformanceCountToSeconds(hpc - s_anchorHPC) : -PerformanceCountToSeconds(s_anchorHPC - hpc);
+	std::chrono::system_clock::time_point time = s_anchorTime
+		+ std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::duration<double>(secondsFromAnchor));
+	return GetTimestampString(std::chrono::system_clock::to_time_t(time));
+}
@@ -35,4 +35,6 @@ double GetElapsedTime(u64 startHPC, u64 endHPC);
 
 std::string GetTimeString(double seconds);
 
-std::string GetTimestamp();
\ No newline at end of file
+std::string GetTimestamp();
+// wall clock time when the performance counter read hpc
+std::string GetTimestamp(u64 hpc);
\ No newline at end of file
@@ -0,0 +1,167 @@
+#include "Engine/Core/TrackingAllocator.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include <atomic>
+#include <cstddef>
+#include <new>
+
+namespace {
+const char* s_memoryTagNames[NUM_MEMORY_TAGS] = {
+	"general",
+	"chunks",
+	"meshes",
+	"net",
+	"resources",
+	"logger"
+};
+
+struct MemoryTagCounters_t {
+	std::atomic<u64>	m_bytes{ 0 };
+	std::atomic<u64>	m_peakBytes{ 0 };
+	std::atomic<u64>	m_numLiveAllocs{ 0 };
+	std::atomic<u64>	m_numTotalAllocs{ 0 };
+	std::atomic<u64>	m_numFrameAllocs{ 0 };
+	std::atomic<u64>	m_numAllocsLastFrame{ 0 };
+	std::atomic<u64>	m_budgetBytes{ 0 };
+};
+
+// constant initialized, safe to count allocations made during static init
+MemoryTagCounters_t s_memoryTagCounters[NUM_MEMORY_TAGS];
+}
+
+void TrackMemoryAlloc(eMemoryTag tag, size_t bytes) {
+	MemoryTagCounters_t& counters = s_memoryTagCounters[tag];
+	u64 oldBytes = counters.m_bytes.fetch_add(bytes, std::memory_order_relaxed);
+	u64 newBytes = oldBytes + bytes;
+	++counters.m_numLiveAllocs;
+	++counters.m_numTotalAllocs;
+	++counters.m_numFrameAllocs;
+
+	u64 peakBytes = counters.m_peakBytes.load(std::memory_order_relaxed);
+	while (newBytes > peakBytes && !counters.m_peakBytes.compare_exchange_weak(peakBytes, newBytes, std::memory_order_relaxed)) {}
+
+	u64 budgetBytes = counters.m_budgetBytes.load(std::memory_order_relaxed);
+	if (budgetBytes > 0 && oldBytes <= budgetBytes && newBytes > budgetBytes) {
+		DebuggerPrintf("Memory tag %s went over its budget: %s of %s\n", s_memoryTagNames[tag],
+			GetMemorySizeString(newBytes).c_str(), GetMemorySizeString(budgetBytes).c_str());
+	}
+}
+
+void TrackMemoryFree(eMemoryTag tag, size_t bytes) {
+	MemoryTagCounters_t& counters = s_memoryTagCounters[tag];
+	counters.m_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+	--counters.m_numLiveAllocs;
+}
+
+void MarkMemoryFrame() {
+	for (int tagIdx = 0; tagIdx < NUM_MEMORY_TAGS; ++tagIdx) {
+		MemoryTagCounters_t& counters = s_memoryTagCounters[tagIdx];
+		counters.m_numAllocsLastFrame.store(counters.m_numFrameAllocs.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+	}
+}
+
+void SetMemoryBudget(eMemoryTag tag, size_t bytes) {
+	s_memoryTagCounters[tag].m_budgetBytes = bytes;
+}
+
+MemoryTagStats_t GetMemoryTagStats(eMemoryTag tag) {
+	const MemoryTagCounters_t& counters = s_memoryTagCounters[tag];
+	MemoryTagStats_t stats;
+	stats.m_name = s_memoryTagNames[tag];
+	stats.m_bytes = counters.m_bytes.load(std::memory_order_relaxed);
+	stats.m_peakBytes = counters.m_peakBytes.load(std::memory_order_relaxed);
+	stats.m_numLiveAllocs = counters.m_numLiveAllocs.load(std::memory_order_relaxed);
+	stats.m_numTotalAllocs = counters.m_numTotalAllocs.load(std::memory_order_relaxed);
+	stats.m_numAllocsLastFrame = counters.m_numAllocsLastFrame.load(std::memory_order_relaxed);
+	stats.m_budgetBytes = counters.m_budgetBytes.load(std::memory_order_relaxed);
+	return stats;
+}
+
+const char* GetMemoryTagName(eMemoryTag tag) {
+	return s_memoryTagNames[tag];
+}
+
+bool GetMemoryTagFromName(const std::string& name, eMemoryTag& out) {
+	for (int tagIdx = 0; tagIdx < NUM_MEMORY_TAGS; ++tagIdx) {
+		if (name == s_memoryTagNames[tagIdx]) {
+			out = (eMemoryTag)tagIdx;
+			return true;
+		}
+	}
+	return false;
+}
+
+std::string GetMemorySizeString(u64 bytes) {
+	if (bytes >= 1024ULL * 1024ULL * 1024ULL) {
+		return Stringf("%.2f GiB", (double)bytes / (1024.0 * 1024.0 * 1024.0));
+	}
+	if (bytes >= 1024ULL * 1024ULL) {
+		return Stringf("%.2f MiB", (double)bytes / (1024.0 * 1024.0));
+	}
+	if (bytes >= 1024ULL) {
+		return Stringf("%.2f KiB", (double)bytes / 1024.0);
+	}
+	return Stringf("%llu B", (unsigned long long)bytes);
+}
+
+//------------------------------------------------------------------------
+// what plain new guarantees, only 8 bytes on Win32
+#if defined(__STDCPP_DEFAULT_NEW_ALIGNMENT__)
+constexpr size_t DEFAULT_NEW_ALIGNMENT = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+#else
+constexpr size_t DEFAULT_NEW_ALIGNMENT = alignof(std::max_align_t);
+#endif
+
+void* HeapAllocator::Alloc(size_t size, size_t alignment /*= 16*/) {
+	if (alignment <= DEFAULT_NEW_ALIGNMENT) {
+		return ::operator new(size);
+	}
+	return AllocAligned(size, alignment);
+}
+
+void HeapAllocator::Free(void* ptr, size_t /*size*/, size_t alignment /*= 16*/) {
+	// has to pick the same way Alloc did
+	if (alignment <= DEFAULT_NEW_ALIGNMENT) {
+		::operator delete(ptr);
+	}
+	else {
+		FreeAligned(ptr);
+	}
+}
+
+HeapAllocator& HeapAllocator::Get() {
+	static HeapAllocator* s_heap = new HeapAllocator();
+	return *s_heap;
+}
+
+//------------------------------------------------------------------------
+TrackingAllocator::TrackingAllocator(eMemoryTag tag, IAllocator& parent)
+	: m_tag(tag)
+	, m_parent(parent) {
+}
+
+void* TrackingAllocator::Alloc(size_t size, size_t alignment /*= 16*/) {
+	void* ptr = m_parent.Alloc(size, alignment);
+	TrackMemoryAlloc(m_tag, size);
+	return ptr;
+}
+
+void TrackingAllocator::Free(void* ptr, size_t size, size_t alignment /*= 16*/) {
+	if (ptr == nullptr) {
+		return;
+	}
+	m_parent.Free(ptr, size, alignment);
+	TrackMemoryFree(m_tag, size);
+}
+
+TrackingAllocator& TrackingAllocator::Get(eMemoryTag tag) {
+	// never destroyed, containers may still free into them at exit
+	static TrackingAllocator** s_allocators = [] {
+		TrackingAllocator** allocators = new TrackingAllocator*[NUM_MEMORY_TAGS];
+		for (int tagIdx = 0; tagIdx < NUM_MEMORY_TAGS; ++tagIdx) {
+			allocators[tagIdx] = new TrackingAllocator((eMemoryTag)tagIdx, HeapAllocator::Get());
+		}
+		return allocators;
+	}();
+	return *s_allocators[tag];
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include "Engine/Core/IAllocator.hpp"
+#include <string>
+
+// who the memory belongs to, every tag has its own counters and budget
+enum eMemoryTag {
+	MEMORY_TAG_GENERAL = 0,
+	MEMORY_TAG_CHUNKS,
+	MEMORY_TAG_MESHES,
+	MEMORY_TAG_NET,
+	MEMORY_TAG_RESOURCES,
+	MEMORY_TAG_LOGGER,
+	NUM_MEMORY_TAGS
+};
+
+struct MemoryTagStats_t {
+	const char*	m_name = nullptr;
+	u64			m_bytes = 0;
+	u64			m_peakBytes = 0;
+	u64			m_numLiveAllocs = 0;
+	u64			m_numTotalAllocs = 0;
+	u64			m_numAllocsLastFrame = 0;
+	u64			m_budgetBytes = 0;		// 0 means no budget
+	bool IsOverBudget() const { return m_budgetBytes > 0 && m_bytes > m_budgetBytes; }
+};
+
+// Counting only, for memory that doesn't come from a TrackingAllocator (stb images, log text...)
+void TrackMemoryAlloc(eMemoryTag tag, size_t bytes);
+void TrackMemoryFree(eMemoryTag tag, size_t bytes);
+
+void MarkMemoryFrame();	// closes the allocations per frame count
+void SetMemoryBudget(eMemoryTag tag, size_t bytes);	// warns once every time the tag goes over
+MemoryTagStats_t GetMemoryTagStats(eMemoryTag tag);
+const char* GetMemoryTagName(eMemoryTag tag);
+bool GetMemoryTagFromName(const std::string& name, eMemoryTag& out);
+std::string GetMemorySizeString(u64 bytes);
+
+// The general heap
+class HeapAllocator : public IAllocator {
+public:
+	void* Alloc(size_t size, size_t alignment = 16) override;
+	void Free(void* ptr, size_t size, size_t alignment = 16) override;
+
+	static HeapAllocator& Get();
+};
+
+// Counts whatever goes through it against one tag, the memory itself comes from its parent
+class TrackingAllocator : public IAllocator {
+public:
+	TrackingAllocator(eMemoryTag tag, IAllocator& parent);
+
+	void* Alloc(size_t size, size_t alignment = 16) override;
+	void Free(void* ptr, size_t size, size_t alignment = 16) override;
+
+	eMemoryTag GetTag() const { return m_tag; }
+
+	// tracks on top of the heap
+	static TrackingAllocator& Get(eMemoryTag tag);
+
+private:
+	eMemoryTag		m_tag;
+	IAllocator&		m_parent;
+};
+
+// Standard allocator counting a container's memory against TAG
+template <typename T, eMemoryTag TAG>
+class TrackedAllocatorSTL {
+public:
+	typedef T value_type;
+	template <typename U>
+	struct rebind {
+		typedef TrackedAllocatorSTL<U, TAG> other;
+	};
+
+	TrackedAllocatorSTL() = default;
+	template <typename U>
+	TrackedAllocatorSTL(const TrackedAllocatorSTL<U, TAG>&) {}
+
+	T* allocate(size_t n) { return static_cast<T*>(TrackingAllocator::Get(TAG).Alloc(n * sizeof(T), alignof(T))); }
+	void deallocate(T* ptr, size_t n) { TrackingAllocator::Get(TAG).Free(ptr, n * sizeof(T), alignof(T)); }
+};
+
+template <typename T, typename U, eMemoryTag TAG>
+inline bool operator==(const TrackedAllocatorSTL<T, TAG>&, const TrackedAllocatorSTL<U, TAG>&) { return true; }
+
+template <typename T, typename U, eMemoryTag TAG>
+inline bool operator!=(const TrackedAllocatorSTL<T, TAG>&, const TrackedAllocatorSTL<U, TAG>&) { return false; }
@@ -1,62 +1,54 @@
 #pragma once
-#include "Engine/Core/ErrorWarningAssert.hpp"
-#include <mutex>
+#include "Engine/Core/type.hpp"
+#include <atomic>
 
+// Hands the latest value from one writer thread to one reader thread, neither ever waits.
+// The writer and the reader each own a buffer, the third one sits in the middle.
+// The middle index and a "fresh" bit live in one atomic, publishing and picking up
+// are each a single exchange. The reader always gets the newest write and skips older ones.
 template <typename T>
 class TripleBuffer{
 public:
 	TripleBuffer() = default;
 	~TripleBuffer() = default;
+	TripleBuffer(const TripleBuffer&) = delete;
+	TripleBuffer& operator=(const TripleBuffer&) = delete;
 
+	// writer only, the buffer stays the writer's until EndWrite
 	T*		BeginWrite();
 	void	EndWrite();
+	// reader only, nullptr until the first write, stays valid until the next Read
 	T*		Read();
 
-// 	T*		LockForWrite(); 
-// 	void	EndWrite();
-// 
-// 	T const* LockForRead(); 
-// 	void UnlockRead(); 
-
 private:
-	T m_buffer[3];
-	int dirty = 0;
-	int clean = 1;
-	int ready = -1;
-	bool hasNewWrite = false;
+	static constexpr u8 INDEX_MASK = 0x3;
+	static constexpr u8 FRESH_BIT = 0x4;
 
-	std::mutex m_mutex;
+	T m_buffer[3];
+	u8 m_writeIdx = 0;	// writer's own
+	u8 m_readIdx = 1;	// reader's own
+	bool m_hasRead = false;
+	std::atomic<u8> m_middle{ 2 };
 };
 
 template <typename T>
 T* TripleBuffer<T>::Read() {
-	std::unique_lock<std::mutex> lock(m_mutex);
-	if (hasNewWrite) {
-		if(ready == -1){
-			// only for the first ready data
-			ready = 2;
-		}
-		std::swap(clean, ready);
-		hasNewWrite = false;
+	if (m_middle.load(std::memory_order_relaxed) & FRESH_BIT) {
+		// only the writer sets the bit, so it's still fresh after the swap
+		u8 middle = m_middle.exchange(m_readIdx, std::memory_order_acq_rel);
+		m_readIdx = middle & INDEX_MASK;
+		m_hasRead = true;
 	}
-	else{
-		if (ready == -1) {
-			return nullptr;
-		}
-	}
-	return &m_buffer[ready];
+	return m_hasRead ? &m_buffer[m_readIdx] : nullptr;
 }
 
 template <typename T>
 void TripleBuffer<T>::EndWrite() {
-	std::unique_lock<std::mutex> lock(m_mutex);
-	hasNewWrite = true;
-	std::swap(dirty, clean);
+	u8 middle = m_middle.exchange(m_writeIdx | FRESH_BIT, std::memory_order_acq_rel);
+	m_writeIdx = middle & INDEX_MASK;
 }
 
 template <typename T>
 T* TripleBuffer<T>::BeginWrite() {
-	std::unique_lock<std::mutex> lock(m_mutex);
-	return &m_buffer[dirty];
+	return &m_buffer[m_writeIdx];
 }
-
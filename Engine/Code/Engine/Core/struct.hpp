@@ -2,11 +2,16 @@
 #include "Engine/Core/type.hpp"
 #include "Engine/Core/Rgba.hpp"
 #include <string>
+#include <utility>
 
 struct ConsoleString {
 	ConsoleString() = default;
 	ConsoleString(std::string str, const Rgba& color, ConsoleString* cstr = nullptr)
-		:m_str(str), m_color(color), m_cstrInfo(cstr) {}
+		:m_str(std::move(str)), m_color(color), m_cstrInfo(cstr) {}
+	ConsoleString(const ConsoleString&) = default;
+	ConsoleString(ConsoleString&&) = default;
+	ConsoleString& operator=(const ConsoleString&) = default;
+	ConsoleString& operator=(ConsoleString&&) = default;
 	~ConsoleString() { if (m_cstrInfo) m_cstrInfo; m_cstrInfo = nullptr; }
 
 	std::string m_str;
@@ -24,6 +24,17 @@ using Uptr = std::unique_ptr<T>;
 template<typename T>
 using Sptr = std::shared_ptr<T>;
 
+// one address per type, no RTTI needed
+using TypeId = const void*;
+template<typename T>
+struct TypeIdTag_t {
+	static char s_tag;	// not const, the linker must not fold identical constants together
+};
+template<typename T>
+char TypeIdTag_t<T>::s_tag = 0;
+template<typename T>
+constexpr TypeId GetTypeId() { return &TypeIdTag_t<T>::s_tag; }
+
 enum ePrimitiveType {
 	PRIMITIVE_TYPE_POINTLIST,
 	PRIMITIVE_TYPE_LINELIST,
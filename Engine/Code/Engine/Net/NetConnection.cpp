@@ -5,10 +5,27 @@
 #include "Engine/Core/Time.hpp"
 #include "Engine/Core/ErrorWarningAssert.hpp"
 #include "Engine/Core/Clock.hpp"
+#include "Engine/Core/BlockAllocator.hpp"
+#include "Engine/Core/FrameAllocator.hpp"
 #include "Engine/Math/MathUtils.hpp"
 #include <bitset>
 #include <algorithm>
 
+// never destroyed, connections may die during static destruction
+static BlockAllocator& GetPacketTrackerPool() {
+	static BlockAllocator* s_pool = new BlockAllocator("PacketTracker", sizeof(PacketTracker_t), 16, 256, MEMORY_TAG_NET);
+	return *s_pool;
+}
+
+void* PacketTracker_t::operator new(size_t size) {
+	return GetPacketTrackerPool().Alloc(size);
+}
+
+void PacketTracker_t::operator delete(void* ptr, size_t size) {
+	GetPacketTrackerPool().Free(ptr, size);
+}
+
+//------------------------------------------------------------------------
 NetConnection::NetConnection() {
 
 }
@@ -89,7 +106,7 @@ void NetConnection::Flush() {
 	if(m_owningSession->IsHost() && m_owningSession->m_myConnection != this){
 		NetObjectSystem* nos = m_owningSession->GetNetObjectSystem();
 
-		std::list<NetObjectView*> updates;
+		std::list<NetObjectView*, FrameAllocatorSTL<NetObjectView*>> updates;
 		if (!nos->m_connectionViews.empty()) {
 			NetObjectConnectionView* connectionView = nos->m_connectionViews[m_info.index].get();
 			if (connectionView && !connectionView->m_netObjViews.empty()) {
@@ -117,14 +134,13 @@ void NetConnection::Flush() {
 					NetMessage updateMsg(msgDef);
 					updateMsg.WriteBytes(&defn->m_id, 1);
 					updateMsg.WriteBytes(&networkID, 2);
-					// new off the snapshot
-					netObj->m_currentSnapshot = new u8[defn->m_snapshotSize];
+					// only needed while writing the message
+					netObj->m_currentSnapshot = g_theFrameAllocator.AllocArray<u8>(defn->m_snapshotSize);
 					defn->m_getSnapshotFunc(netObj->m_currentSnapshot, netObj->m_localObj);
 					defn->m_sendSnapshotFunc(updateMsg, netObj->m_currentSnapshot);
 					packet.WriteMessage(updateMsg);
 					header.messageCount++;
 
-					delete netObj->m_currentSnapshot;
 					netObj->m_currentSnapshot = nullptr;
 
 					netObjView->m_lastSentTime = m_owningSession->GetNetTimeInSeconds();
@@ -165,6 +181,8 @@ void NetConnection::Receive(NetPacket* packet, PacketHeader_t* header) {
 	if (CheckRandomChance(m_owningSession->m_lossChance) == true) {
 		// packet is lost
 /*		LogWarningf("packet simulate lost");*/
+		delete packet;
+		delete header;
 		return;
 	}
 
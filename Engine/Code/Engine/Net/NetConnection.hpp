@@ -23,6 +23,10 @@ struct PacketTracker_t{
 	u16	reliableIDs[MAX_RELIABLES_PER_PACKET];
 	u16 reliableCount = 0U;
 	u16 ack = INVALID_PACKET_ACK;
+
+	// one per flush, comes from a block pool
+	static void* operator new(size_t size);
+	static void operator delete(void* ptr, size_t size);
 };
 
 class NetConnection {
@@ -1,6 +1,28 @@
 #include "Engine/Net/NetPacket.hpp"
 #include "Engine/Net/NetSession.hpp"
 #include "Engine/Core/Logger.hpp"
+#include "Engine/Core/BlockAllocator.hpp"
+
+// never destroyed, packets may still be in flight during shutdown
+static BlockAllocator& GetPacketHeaderPool() {
+	static BlockAllocator* s_pool = new BlockAllocator("PacketHeader", sizeof(PacketHeader_t), 16, 256, MEMORY_TAG_NET);
+	return *s_pool;
+}
+
+static BlockAllocator& GetNetPacketPool() {
+	static BlockAllocator* s_pool = new BlockAllocator("NetPacket", sizeof(NetPacket), 16, 256, MEMORY_TAG_NET);
+	return *s_pool;
+}
+
+void* PacketHeader_t::operator new(size_t size) {
+	return GetPacketHeaderPool().Alloc(size);
+}
+
+void PacketHeader_t::operator delete(void* ptr, size_t size) {
+	GetPacketHeaderPool().Free(ptr, size);
+}
+
+//------------------------------------------------------------------------
 
 NetPacket::NetPacket() 
 	: BytePacker(PACKET_MTU) {
@@ -27,6 +49,14 @@ NetPacket::~NetPacket() {
 
 }
 
+void* NetPacket::operator new(size_t size) {
+	return GetNetPacketPool().Alloc(size);
+}
+
+void NetPacket::operator delete(void* ptr, size_t size) {
+	GetNetPacketPool().Free(ptr, size);
+}
+
 bool NetPacket::WriteHeader(const PacketHeader_t& header) {
 	if(WriteBytes(&header.senderConnectionIdx, 1) == false){
 		return false;
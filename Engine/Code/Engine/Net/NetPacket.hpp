@@ -27,6 +27,10 @@ volatile struct PacketHeader_t {
 	u16 lastReceivedAck;
 	u16 previousReceivedAckBitfield;
 	u8	messageCount; // number of messages in this container
+
+	// one per received datagram, comes from a block pool
+	static void* operator new(size_t size);
+	static void operator delete(void* ptr, size_t size);
 };
 
 struct NetSender_t {
@@ -58,6 +62,10 @@ public:
 	bool WriteMessage(const NetMessage& msg);
 	bool ReadMessage(NetMessage& out) const;
 
+	// one per received datagram, comes from a block pool
+	static void* operator new(size_t size);
+	static void operator delete(void* ptr, size_t size);
+
 public:
 	mutable NetSender_t		m_sender;
 };
\ No newline at end of file
@@ -15,17 +15,17 @@
 static bool OnPing(const NetMessage& msg, const NetSender_t& from) {
 	std::string payload;
 	msg.ReadString(payload);
-	LogTaggedPrintf("netsession", "Received [ping] from %s : %s", from.address.ToString().c_str(), payload.c_str());
+	LogFastTaggedPrintf("netsession", "Received [ping] from %s : %s", from.address.ToString().c_str(), payload.c_str());
 
 	NetMessageDefinition_t* msgDef = from.session->GetMessageDefinitionByName("pong");
 	NetMessage pong(msgDef);
 
 	if (from.netConn == nullptr) {
-		LogTaggedPrintf("netsession", "No connections, responding to address directly");
+		LogFastTaggedPrintf("netsession", "No connections, responding to address directly");
 		from.session->SendDirectMessage(from.address, pong);
 	}
 	else {
-		LogTaggedPrintf("netsession", "Responding to connection.");
+		LogFastTaggedPrintf("netsession", "Responding to connection.");
 		from.netConn->Send(pong);
 	}
 	return true;
@@ -33,7 +33,7 @@ static bool OnPing(const NetMessage& msg, const NetSender_t& from) {
 
 static bool OnPong(const NetMessage& msg, const NetSender_t& from) {
 	UNUSED(msg);
-	LogTaggedPrintf("netsession", "Received [pong] from %s", from.address.ToString().c_str());
+	LogFastTaggedPrintf("netsession", "Received [pong] from %s", from.address.ToString().c_str());
 	return true;
 }
 
@@ -46,7 +46,7 @@ static bool OnAdd(const NetMessage& msg, const NetSender_t& from) {
 	if (msg.ReadBytes(&b, 4) != 4) {
 		return false;
 	}
-	LogTaggedPrintf("netsession", "Received [add] from %s: %.5f + %.5f = %.5f", from.address.ToString().c_str(), a, b, a + b);
+	LogFastTaggedPrintf("netsession", "Received [add] from %s: %.5f + %.5f = %.5f", from.address.ToString().c_str(), a, b, a + b);
 
 	NetMessageDefinition_t* msgDef = from.session->GetMessageDefinitionByName("add_response");
 	NetMessage addresponse(msgDef);
@@ -56,11 +56,11 @@ static bool OnAdd(const NetMessage& msg, const NetSender_t& from) {
 	addresponse.WriteBytes(&result, 4);
 
 	if (from.netConn == nullptr) {
-		LogTaggedPrintf("netsession", "No connections, responding to address directly");
+		LogFastTaggedPrintf("netsession", "No connections, responding to address directly");
 		from.session->SendDirectMessage(from.address, addresponse);
 	}
 	else {
-		LogTaggedPrintf("netsession", "Responding to connection.");
+		LogFastTaggedPrintf("netsession", "Responding to connection.");
 		from.netConn->Send(addresponse);
 	}
 	return true;
@@ -74,7 +74,7 @@ static bool OnAddResponse(const NetMessage& msg, const NetSender_t& from) {
 	msg.ReadBytes(&b, 4);
 	msg.ReadBytes(&result, 4);
 
-	LogTaggedPrintf("netsession", "Received [add_response] from %s : %.5f + %.5f = %.5f", from.address.ToString().c_str(), a, b, result);
+	LogFastTaggedPrintf("netsession", "Received [add_response] from %s : %.5f + %.5f = %.5f", from.address.ToString().c_str(), a, b, result);
 	return true;
 }
 
@@ -92,18 +92,18 @@ static bool OnUnreliableTest(const NetMessage& msg, const NetSender_t& from){
 	int count = 0;
 	msg.ReadBytes(&i, 4);
 	msg.ReadBytes(&count, 4);
-	LogTaggedPrintf("netsession", "(%d, %d)", i + 1, count);
+	LogFastTaggedPrintf("netsession", "(%d, %d)", i + 1, count);
 	return true;
 }
 
 static bool OnTest(const NetMessage& msg, const NetSender_t& from) {
 	if (from.netConn == nullptr) {
-		LogTaggedPrintf("netsession", "Received a message that requires connection. Throw out!");
+		LogFastTaggedPrintf("netsession", "Received a message that requires connection. Throw out!");
 	}
 	else {
 		std::string payload;
 		msg.ReadString(payload);
-		LogTaggedPrintf("netsession", "Received [test] from %s : %s", from.address.ToString().c_str(), payload.c_str());
+		LogFastTaggedPrintf("netsession", "Received [test] from %s : %s", from.address.ToString().c_str(), payload.c_str());
 	}
 	return true;
 }
@@ -113,7 +113,7 @@ static bool OnReliableTest(const NetMessage& msg, const NetSender_t& from) {
 	int count = 0;
 	msg.ReadBytes(&i, 4);
 	msg.ReadBytes(&count, 4);
-	LogTaggedPrintf("netsession", "Reliable: (%d, %d)", i + 1, count);
+	LogFastTaggedPrintf("netsession", "Reliable: (%d, %d)", i + 1, count);
 	NetMessageDefinition_t* msgDef = from.session->GetMessageDefinitionByName("heartbeat");
 	NetMessage heartbeat(msgDef);
 	from.netConn->Send(heartbeat);
@@ -125,7 +125,7 @@ static bool OnInOrderTest(const NetMessage& msg, const NetSender_t& from) {
 	int count = 0;
 	msg.ReadBytes(&i, 4);
 	msg.ReadBytes(&count, 4);
-	LogTaggedPrintf("netsession", "InOrder: (%d, %d)", i + 1, count);
+	LogFastTaggedPrintf("netsession", "InOrder: (%d, %d)", i + 1, count);
 	NetMessageDefinition_t* msgDef = from.session->GetMessageDefinitionByName("heartbeat");
 	NetMessage heartbeat(msgDef);
 	from.netConn->Send(heartbeat);
@@ -474,6 +474,8 @@ void NetSession::ProcessIncomingPackets() {
 			}
 			else {
 				LogWarningf("Read packet header failed");
+				delete packet;
+				delete header;
 			}
 		}
 	}
@@ -511,7 +513,7 @@ void NetSession::SendDirectMessage(u8 connectionIdx, const NetMessage& msg) {
 }
 
 void NetSession::ProcessDirectMessage(NetPacket* packet, PacketHeader_t* header) {
-	LogTaggedPrintf("netsession", "ProcessDirectMessage");
+	LogFastTaggedPrintf("netsession", "ProcessDirectMessage");
 	// Read messages
 	for (u8 msgIdx = 0; msgIdx < header->messageCount; ++msgIdx) {
 		NetMessage msg;
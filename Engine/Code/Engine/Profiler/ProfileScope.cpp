@@ -14,11 +14,15 @@ LogProfileScope::~LogProfileScope() {
 	DebuggerPrintf("[%s] took %.2f ms.\n", m_tag.c_str(), PerformanceCountToSeconds(elapsed) * 1000.0);
 }
 
-ProfileScope::ProfileScope(const std::string& tag) 
-	:m_tag(tag) {
-	g_theProfiler->Push(tag);
+#if defined(PROFILER_ENABLED)
+ProfileScope::ProfileScope(StringId tag)
+	: m_tag(tag)
+	, m_isRecorded(Profiler::PushScope(tag)) {
 }
 
 ProfileScope::~ProfileScope() {
-	g_theProfiler->Pop();
+	if (m_isRecorded) {
+		Profiler::PopScope(m_tag);
+	}
 }
+#endif
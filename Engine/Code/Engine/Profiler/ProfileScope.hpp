@@ -1,5 +1,7 @@
 #pragma once
 #include "Engine/Core/type.hpp"
+#include "Engine/Core/StringId.hpp"
+#include "Game/EngineBuildPreferences.hpp"
 #include <string>
 
 class LogProfileScope {
@@ -12,17 +14,28 @@ private:
 	u64 m_startHPC;
 };
 
-#define PROFILE_LOG_SCOPE(s) LogProfileScope __timer_ ##__LINE__ ## (s)
-#define PROFILE_LOG_SCOPE_FUNCTION() LogProfileScope __timer_ ##__LINE__ ## (__FUNCTION__)
+#define PROFILE_CONCAT_IMPL(a, b) a ## b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
 
+#define PROFILE_LOG_SCOPE(s) LogProfileScope PROFILE_CONCAT(__timer_, __LINE__)(s)
+#define PROFILE_LOG_SCOPE_FUNCTION() LogProfileScope PROFILE_CONCAT(__timer_, __LINE__)(__FUNCTION__)
+
+// Records a begin and an end event in the calling thread's profiler ring.
 class ProfileScope {
 public:
-	ProfileScope(const std::string& tag);
+	explicit ProfileScope(StringId tag);
 	~ProfileScope();
 
 private:
-	std::string m_tag;
+	StringId	m_tag;
+	bool		m_isRecorded;	// the end goes in only if the begin did
 };
 
-#define PROFILE_SCOPE(s) ProfileScope __timer_ ##__LINE__ ## (s)
-#define PROFILE_SCOPE_FUNTION() ProfileScope __timer_ ##__LINE__ ## (__FUNCTION__)
+#if defined(PROFILER_ENABLED)
+// the tag is interned once per call site, every lambda has its own static
+#define PROFILE_SCOPE(s) ProfileScope PROFILE_CONCAT(__timer_, __LINE__)([](const char* tag) { static const StringId s_tag = CreateOrGetStringId(tag); return s_tag; }(s))
+#define PROFILE_SCOPE_FUNTION() PROFILE_SCOPE(__FUNCTION__)
+#else
+#define PROFILE_SCOPE(s)
+#define PROFILE_SCOPE_FUNTION()
+#endif
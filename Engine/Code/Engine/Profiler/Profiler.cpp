@@ -5,11 +5,22 @@
 #include "Engine/Core/ErrorWarningAssert.hpp"
 #include "Engine/Core/Clock.hpp"
 #include "Engine/Core/Time.hpp"
+#include "Engine/Core/ChromeTraceWriter.hpp"
 #include "Engine/Core/Camera.hpp"
 #include "Engine/Core/Window.hpp"
 #include "Engine/Core/DevConsole.hpp"
 #include "Engine/Core/StringUtils.hpp"
+#include "Engine/Core/TrackingAllocator.hpp"
+#include "Engine/Core/BlockAllocator.hpp"
+#include "Engine/Core/Thread.hpp"
+#include "Engine/Core/ThreadSafeContainer.hpp"
 #include "Engine/InputSystem/InputSystem.hpp"
+#include "Engine/Renderer/d3d11/RHIInstance.hpp"
+#include "Engine/Renderer/d3d11/RHIOutput.hpp"
+#include "Engine/Renderer/d3d11/FontRenderer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
 
 #if defined(PROFILER_ENABLED)
 
@@ -46,12 +57,229 @@ static bool Command_ProfilerResume(Command& cmd) {
 	}
 }
 
+static bool Command_ProfilerExport(Command& cmd) {
+	std::string filePath = "Log/profiler_trace.json";
+	if (!cmd.m_args.empty()) {
+		cmd.GetNextArg<std::string>(filePath);
+	}
+	if (!g_theProfiler->WriteChromeTrace(filePath)) {
+		ConsolePrintf(Rgba::RED, "Failed to write profiler trace to %s", filePath.c_str());
+		return true;
+	}
+	ConsolePrintf("Profiler history of %u frames written to %s", g_theProfiler->GetFrameSize(), filePath.c_str());
+	return true;
+}
+
+static std::string GetScopeStatsString(const ProfileScopeStats_t& stats) {
+	return Stringf("%-40s p50 %-10s p95 %-10s p99 %-10s max %-10s stddev %-10s frames %u",
+		stats.m_tag, GetTimeString(stats.m_p50).c_str(), GetTimeString(stats.m_p95).c_str(), GetTimeString(stats.m_p99).c_str(),
+		GetTimeString(stats.m_max).c_str(), GetTimeString(stats.m_stddev).c_str(), stats.m_numSamples);
+}
+
+static bool Command_ProfilerDump(Command& cmd) {
+	if (cmd.m_args.empty()) {
+		g_theProfiler->StopReportDump();
+		ConsolePrintf("Profiler report dump is off");
+		return true;
+	}
+
+	std::string filePath;
+	int frameInterval = 0;
+	cmd.GetNextArg<std::string>(filePath);
+	if (!cmd.m_args.empty() && !cmd.GetNextArg<int>(frameInterval)) {
+		return false;
+	}
+	if (!g_theProfiler->StartReportDump(filePath, frameInterval)) {
+		ConsolePrintf(Rgba::RED, "Profiler report interval has to be 0 to %d frames", MAX_FRAMEHISTORY_COUNT);
+		return true;
+	}
+	if (frameInterval > 0) {
+		ConsolePrintf("Profiler report of every %d frames written next to %s", frameInterval, filePath.c_str());
+	}
+	else {
+		ConsolePrintf("Profiler report written to %s on exit", filePath.c_str());
+	}
+	return true;
+}
+
+static bool Command_ProfilerStats(Command& cmd) {
+	int count = 10;
+	if (!cmd.m_args.empty() && (!cmd.GetNextArg<int>(count) || count < 0)) {
+		return false;
+	}
+
+	ConsolePrintf("%s", GetScopeStatsString(g_theProfiler->GetFrameStats()).c_str());
+	std::vector<ProfileScopeStats_t> scopeStats;
+	g_theProfiler->GetScopeStats(scopeStats);
+	for (size_t statsIdx = 0; statsIdx < scopeStats.size() && statsIdx < (size_t)count; ++statsIdx) {
+		ConsolePrintf("%s", GetScopeStatsString(scopeStats[statsIdx]).c_str());
+	}
+	return true;
+}
+
+static bool Command_ProfilerSpike(Command& cmd) {
+	float milliseconds = 0.f;
+	if (!cmd.GetNextArg<float>(milliseconds) || milliseconds < 0.f) {
+		return false;
+	}
+
+	g_theProfiler->SetSpikeBudget(milliseconds / 1000.0);
+	if (milliseconds > 0.f) {
+		ConsolePrintf("Profiler pauses on frames over %.2f ms", milliseconds);
+	}
+	else {
+		ConsolePrintf("Profiler spike pause is off");
+	}
+	return true;
+}
+
+static std::string GetMemoryTagStatsString(const MemoryTagStats_t& stats) {
+	std::string budget = stats.m_budgetBytes > 0 ? GetMemorySizeString(stats.m_budgetBytes) : "-";
+	return Stringf("%-10s %12s / %-12s peak %-12s live %-8llu allocs/frame %llu",
+		stats.m_name, GetMemorySizeString(stats.m_bytes).c_str(), budget.c_str(), GetMemorySizeString(stats.m_peakBytes).c_str(),
+		(unsigned long long)stats.m_numLiveAllocs, (unsigned long long)stats.m_numAllocsLastFrame);
+}
+
+static bool Command_MemoryStats(Command& cmd) {
+	if (!cmd.m_args.empty()) {
+		return false;
+	}
+
+	for (int tagIdx = 0; tagIdx < NUM_MEMORY_TAGS; ++tagIdx) {
+		MemoryTagStats_t stats = GetMemoryTagStats((eMemoryTag)tagIdx);
+		if (stats.IsOverBudget()) {
+			ConsolePrintf(Rgba::RED, "%s", GetMemoryTagStatsString(stats).c_str());
+		}
+		else {
+			ConsolePrintf("%s", GetMemoryTagStatsString(stats).c_str());
+		}
+	}
+
+	std::vector<BlockAllocatorStats_t> poolStats;
+	BlockAllocator::GetAllStats(poolStats);
+	for (const BlockAllocatorStats_t& stats : poolStats) {
+		ConsolePrintf("pool %-14s %4zu B blocks, in use %llu of %llu, peak %llu", stats.m_name, stats.m_blockSize,
+			(unsigned long long)stats.m_numBlocksInUse, (unsigned long long)stats.m_numBlocksReserved, (unsigned long long)stats.m_peakBlocksInUse);
+	}
+	return true;
+}
+
+static bool Command_MemoryBudget(Command& cmd) {
+	std::string tagName;
+	float megabytes = 0.f;
+	eMemoryTag tag;
+	if (!cmd.GetNextArg<std::string>(tagName) || !GetMemoryTagFromName(tagName, tag) || !cmd.GetNextArg<float>(megabytes) || megabytes < 0.f) {
+		return false;
+	}
+
+	SetMemoryBudget(tag, (size_t)(megabytes * 1024.f * 1024.f));
+	ConsolePrintf("Memory budget of %s is %s", tagName.c_str(), megabytes > 0.f ? GetMemorySizeString((u64)(megabytes * 1024.f * 1024.f)).c_str() : "off");
+	return true;
+}
+
+static std::atomic<bool> s_isRecording{ false };
+
+namespace {
+// Every thread that ever recorded, in the order they started. Leaked, threads may record until exit.
+struct ProfilerThreadRegistry {
+	SpinLock						m_lock;
+	std::vector<Sptr<ProfilerThread_t>>	m_threads;
+	u32								m_numThreadsCreated = 0;
+};
+
+// marks the thread's ring when the thread exits, the profiler drains what's left
+struct ProfilerThreadOwner {
+	~ProfilerThreadOwner() {
+		if (m_thread) {
+			m_thread->m_isThreadAlive = false;
+		}
+	}
+
+	Sptr<ProfilerThread_t> m_thread;
+};
+}
+
+static ProfilerThreadRegistry& GetProfilerThreadRegistry() {
+	static ProfilerThreadRegistry* s_registry = new ProfilerThreadRegistry();
+	return *s_registry;
+}
+
+static thread_local ProfilerThreadOwner s_profilerThread;
+
+static ProfilerThread_t* GetCurrentProfilerThread() {
+	ProfilerThread_t* thread = s_profilerThread.m_thread.get();
+	if (thread != nullptr) {
+		return thread;
+	}
+
+	Sptr<ProfilerThread_t> newThread = std::make_shared<ProfilerThread_t>();
+	std::string name = g_theThreadManager.GetCurrentThreadName();
+	ProfilerThreadRegistry& registry = GetProfilerThreadRegistry();
+	{
+		SpinLockScope scope(registry.m_lock);
+		u32 threadNumber = registry.m_numThreadsCreated++;
+		if (name.empty()) {
+			name = threadNumber == 0 ? "Main" : Stringf("Thread %u", threadNumber);
+		}
+		newThread->m_name = GetStringFromSid(CreateOrGetStringId(name));
+		registry.m_threads.push_back(newThread);
+	}
+	s_profilerThread.m_thread = newThread;
+	return newThread.get();
+}
+
+// nearest rank percentiles, samples are sorted in place
+static ProfileScopeStats_t ComputeScopeStats(const char* tag, std::vector<double>& samples) {
+	ProfileScopeStats_t stats;
+	stats.m_tag = tag;
+	stats.m_numSamples = (u32)samples.size();
+	if (samples.empty()) {
+		return stats;
+	}
+
+	std::sort(samples.begin(), samples.end());
+	auto getPercentile = [&samples](double percent) {
+		size_t rank = (size_t)std::ceil(percent * (double)samples.size());
+		return samples[rank > 0 ? rank - 1 : 0];
+	};
+	stats.m_p50 = getPercentile(0.50);
+	stats.m_p95 = getPercentile(0.95);
+	stats.m_p99 = getPercentile(0.99);
+	stats.m_max = samples.back();
+
+	double sum = 0.0;
+	for (double sample : samples) {
+		sum += sample;
+	}
+	stats.m_mean = sum / (double)samples.size();
+	double sumOfSquares = 0.0;
+	for (double sample : samples) {
+		sumOfSquares += (sample - stats.m_mean) * (sample - stats.m_mean);
+	}
+	stats.m_stddev = std::sqrt(sumOfSquares / (double)samples.size());
+	return stats;
+}
+
 Profiler::Profiler() {
+	// the main thread comes first, nothing records before this
+	GetCurrentProfilerThread();
 	Initialize();
+	s_isRecording = true;
 }
 
 Profiler::~Profiler() {
-
+	s_isRecording = false;
+	if (m_reportDumpPath.empty()) {
+		return;
+	}
+	if (m_reportDumpInterval == 0) {
+		WriteReport(m_reportDumpPath, MAX_FRAMEHISTORY_COUNT);
+	}
+	else if (m_numFramesSinceReportDump > 0) {
+		// what came in since the last numbered report, likely fewer frames than the interval
+		++m_numReportDumps;
+		WriteReport(GetNumberedReportPath(), m_numFramesSinceReportDump);
+	}
 }
 
 void Profiler::Initialize() {
@@ -62,6 +290,12 @@ void Profiler::Initialize() {
 	CommandDefinition::Register("profiler", "[N/A] Toggle profiler.", Command_Profiler);
 	CommandDefinition::Register("profiler_pause", "[N/A] Pause profiler.", Command_ProfilerPause);
 	CommandDefinition::Register("profiler_resume", "[N/A] Resume profiler.", Command_ProfilerResume);
+	CommandDefinition::Register("profiler_stats", "[int count] Print frame time and the slowest scopes' percentiles over the profiler history.", Command_ProfilerStats);
+	CommandDefinition::Register("profiler_spike", "[float ms] Pause the profiler on a frame longer than this, 0 turns it off.", Command_ProfilerSpike);
+	CommandDefinition::Register("profiler_dump", "[string file, int frames] Write the profiler report to a csv or json every so many frames and on exit, no args stops.", Command_ProfilerDump);
+	CommandDefinition::Register("profiler_export", "[string file] Dump the profiler history of all threads as a chrome://tracing json.", Command_ProfilerExport);
+	CommandDefinition::Register("mem_stats", "[N/A] Print memory use by tag and block pool usage.", Command_MemoryStats);
+	CommandDefinition::Register("mem_budget", "[tag] [MB] Set the memory budget of a tag, 0 turns it off.", Command_MemoryBudget);
 
 	// Create mouse boxes
 	m_sortByTotalBoxBound = AABB2(Vector2(960, 465), Vector2(1077, 484));
@@ -75,71 +309,215 @@ void Profiler::Initialize() {
 	m_visualBoxBound = AABB2(Vector2(m_cpuVisualBoxStartX, m_cpuInfoStartY - m_cpuVisualBoxHeight), Vector2(m_cpuVisualBoxStartX + m_cpuVisualBoxWidth, m_cpuInfoStartY));
 }
 
-void Profiler::Push(const std::string& tag) {
-#ifndef PROFILER_ENABLED
-	return;
-#endif
-	if (IsPaused()) {
-		return;
+bool Profiler::PushScope(StringId tag) {
+	if (!s_isRecording.load(std::memory_order_relaxed)) {
+		return false;
 	}
-	// adds a new leaf to the tree, and sets it as the active node.
-	if (m_currentNode != nullptr) {
-		auto newNode = std::make_unique<Profile_Node_t>(tag);
-		newNode->SetStartHPC(GetPerformanceCounter());
-		newNode->SetParent(m_currentNode);
-		m_currentNode->AddChild(std::move(newNode));
-		m_currentNode = m_currentNode->m_children.back().get();
+
+	ProfilerThread_t* thread = GetCurrentProfilerThread();
+	if (!thread->m_events.TryEnqueue(ProfileEvent_t{ GetPerformanceCounter(), tag, PROFILE_EVENT_BEGIN })) {
+		thread->m_numDropped.fetch_add(1, std::memory_order_relaxed);
+		return false;
 	}
+	return true;
 }
 
-void Profiler::Pop() {
-#ifndef PROFILER_ENABLED
-	return;
-#endif
-	if (IsPaused()) {
-		return;
+void Profiler::PopScope(StringId tag) {
+	ProfilerThread_t* thread = GetCurrentProfilerThread();
+	// a lost end is closed at the end of its frame
+	if (!thread->m_events.TryEnqueue(ProfileEvent_t{ GetPerformanceCounter(), tag, PROFILE_EVENT_END })) {
+		thread->m_numDropped.fetch_add(1, std::memory_order_relaxed);
 	}
-	// returns sets the active node to the current active node's parent. If the active node becomes nullptr, then a tree is considered complete;
-	GUARANTEE_OR_DIE(m_currentNode != nullptr, "Profiler::Pop - Someone called pop without a push!");
-	m_currentNode->SetEndHPC(GetPerformanceCounter());
-	m_currentNode = m_currentNode->m_parent;
 }
 
 void Profiler::MarkFrame() {
-#ifndef PROFILER_ENABLED
-	return;
-#endif
-	if (m_currentNode != nullptr) {
-		Pop();
-		GUARANTEE_OR_DIE(m_currentNode == nullptr, "Profiler::MarkFrame - Someone forgot to pop!");
-		// The trick here is you can't immediately pause profiling - you have to let the current frame finish. 
-		// So pausing/resuming does not take affect until the next frame;
-		if (m_isReadyToPause) {
-			m_isPaused = true;
-			m_isReadyToPause = false;
+	MarkMemoryFrame();
+
+	u64 frameBoundaryHPC = GetPerformanceCounter();
+	bool wasRecording = !IsPaused();
+	if (wasRecording && !m_frames.empty()) {
+		m_frames.back().m_endHPC = frameBoundaryHPC;
+	}
+	CollectThreadEvents(wasRecording);
+	if (wasRecording && !m_frames.empty()) {
+		RecordScopeSamples(m_frames.back());
+		if (!m_reportDumpPath.empty() && m_reportDumpInterval > 0 && ++m_numFramesSinceReportDump >= m_reportDumpInterval) {
+			++m_numReportDumps;
+			WriteReport(GetNumberedReportPath(), m_numFramesSinceReportDump);
+			m_numFramesSinceReportDump = 0;
 		}
+		CheckForSpike();
 	}
 
+	// The trick here is you can't immediately pause profiling - you have to let the current frame finish. 
+	// So pausing/resuming does not take affect until the next frame;
+	if (m_isReadyToPause) {
+		m_isPaused = true;
+		m_isReadyToPause = false;
+	}
 	if (IsPaused()) {
 		if (m_isReadyToResume) {
 			m_isPaused = false;
 			m_isReadyToResume = false;
 		}
 		else {
+			s_isRecording = false;
 			return;
 		}
 	}
+	s_isRecording = true;
 
-	// create new node for this frame
-	auto newRoot = std::make_unique<Profile_Node_t>("root");
-	m_currentNode = newRoot.get();
-	m_currentNode->SetStartHPC(GetPerformanceCounter());
-	m_frames.push_back(std::move(newRoot));
+	// start the next frame
+	ProfileFrame_t frame;
+	frame.m_startHPC = frameBoundaryHPC;
+	m_frames.push_back(frame);
 
 	// check frame history length
 	if (m_frames.size() > MAX_FRAMEHISTORY_COUNT) {
 		m_frames.pop_front();
 	}
+	TrimThreadHistories();
+}
+
+void Profiler::CollectThreadEvents(bool keepEvents) {
+	ProfilerThreadRegistry& registry = GetProfilerThreadRegistry();
+	{
+		SpinLockScope scope(registry.m_lock);
+		for (size_t threadIdx = m_threadHistories.size(); threadIdx < registry.m_threads.size(); ++threadIdx) {
+			ThreadHistory_t history;
+			history.m_thread = registry.m_threads[threadIdx];
+			m_threadHistories.push_back(std::move(history));
+		}
+	}
+
+	for (ThreadHistory_t& history : m_threadHistories) {
+		ProfilerThread_t* thread = history.m_thread.get();
+		m_collectBuffer.clear();
+		thread->m_events.DequeueBatch(m_collectBuffer, thread->m_events.GetCapacity());
+		if (keepEvents) {
+			history.m_events.insert(history.m_events.end(), m_collectBuffer.begin(), m_collectBuffer.end());
+		}
+		m_numDroppedEvents += thread->m_numDropped.exchange(0);
+	}
+}
+
+void Profiler::TrimThreadHistories() {
+	u64 oldestHPC = m_frames.front().m_startHPC;
+	for (ThreadHistory_t& history : m_threadHistories) {
+		while (!history.m_events.empty() && history.m_events.front().m_hpc < oldestHPC) {
+			history.m_events.pop_front();
+		}
+	}
+
+	for (auto it = m_scopeSamples.begin(); it != m_scopeSamples.end();) {
+		std::deque<ScopeSample_t>& samples = it->second;
+		while (!samples.empty() && samples.front().m_frameStartHPC < oldestHPC) {
+			samples.pop_front();
+		}
+		if (samples.empty()) {
+			it = m_scopeSamples.erase(it);
+		}
+		else {
+			++it;
+		}
+	}
+
+	// a thread that's gone stays until its last frame leaves the history, index 0 is the main thread
+	ProfilerThreadRegistry& registry = GetProfilerThreadRegistry();
+	SpinLockScope scope(registry.m_lock);
+	for (size_t threadIdx = m_threadHistories.size() - 1; threadIdx > 0; --threadIdx) {
+		ThreadHistory_t& history = m_threadHistories[threadIdx];
+		if (!history.m_thread->m_isThreadAlive && history.m_events.empty() && history.m_thread->m_events.GetApproxSize() == 0) {
+			registry.m_threads.erase(registry.m_threads.begin() + threadIdx);
+			m_threadHistories.erase(m_threadHistories.begin() + threadIdx);
+		}
+	}
+	if (m_viewThreadIdx >= m_threadHistories.size()) {
+		m_viewThreadIdx = 0;
+	}
+}
+
+void Profiler::RecordScopeSamples(const ProfileFrame_t& frame) {
+	// inclusive time of every tag, a recursive scope only counts from its outermost call
+	m_frameScopeHPCs.clear();
+	auto addScopeTime = [this](StringId tag, u64 startHPC, u64 endHPC) {
+		for (const ProfileEvent_t& openScope : m_scopeStack) {
+			if (openScope.m_tag == tag) {
+				return;
+			}
+		}
+		m_frameScopeHPCs[tag] += endHPC - startHPC;
+	};
+
+	for (const ThreadHistory_t& history : m_threadHistories) {
+		m_scopeStack.clear();
+		auto eventIt = std::lower_bound(history.m_events.begin(), history.m_events.end(), frame.m_startHPC,
+			[](const ProfileEvent_t& event, u64 hpc) { return event.m_hpc < hpc; });
+		for (; eventIt != history.m_events.end() && eventIt->m_hpc < frame.m_endHPC; ++eventIt) {
+			if (eventIt->m_type == PROFILE_EVENT_BEGIN) {
+				m_scopeStack.push_back(*eventIt);
+			}
+			else if (!m_scopeStack.empty()) {
+				ProfileEvent_t beginEvent = m_scopeStack.back();
+				m_scopeStack.pop_back();
+				addScopeTime(beginEvent.m_tag, beginEvent.m_hpc, eventIt->m_hpc);
+			}
+			else {
+				// began in an earlier frame, only this frame's part counts
+				addScopeTime(eventIt->m_tag, frame.m_startHPC, eventIt->m_hpc);
+			}
+		}
+		// still running when the frame ended
+		while (!m_scopeStack.empty()) {
+			ProfileEvent_t beginEvent = m_scopeStack.back();
+			m_scopeStack.pop_back();
+			addScopeTime(beginEvent.m_tag, beginEvent.m_hpc, frame.m_endHPC);
+		}
+	}
+
+	for (const auto& scopeHPC : m_frameScopeHPCs) {
+		m_scopeSamples[scopeHPC.first].push_back({ frame.m_startHPC, PerformanceCountToSeconds(scopeHPC.second) });
+	}
+}
+
+void Profiler::CheckForSpike() {
+	const ProfileFrame_t& frame = m_frames.back();
+	double frameSeconds = GetElapsedTime(frame.m_startHPC, frame.m_endHPC);
+	if (m_spikeBudgetSeconds <= 0.0 || frameSeconds <= m_spikeBudgetSeconds || m_isReadyToPause) {
+		return;
+	}
+
+	// stops on the spike itself, it stays the newest frame in history
+	Pause();
+	m_mouseSelectFrameIdx = (int)m_frames.size() - 1;
+	GenerateReport(m_mouseSelectFrameIdx);
+	ConsolePrintf(Rgba::RED, "Frame took %s, over the %s budget. Profiler paused.",
+		GetTimeString(frameSeconds).c_str(), GetTimeString(m_spikeBudgetSeconds).c_str());
+}
+
+ProfileScopeStats_t Profiler::GetFrameStats() const {
+	std::vector<double> samples;
+	for (const ProfileFrame_t& frame : m_frames) {
+		if (frame.m_endHPC != 0) {
+			samples.push_back(GetElapsedTime(frame.m_startHPC, frame.m_endHPC));
+		}
+	}
+	return ComputeScopeStats("Frame", samples);
+}
+
+void Profiler::GetScopeStats(std::vector<ProfileScopeStats_t>& outStats) const {
+	outStats.clear();
+	std::vector<double> samples;
+	for (const auto& scopeSamples : m_scopeSamples) {
+		samples.clear();
+		for (const ScopeSample_t& sample : scopeSamples.second) {
+			samples.push_back(sample.m_seconds);
+		}
+		const char* tag = GetStringFromSid(scopeSamples.first);
+		outStats.push_back(ComputeScopeStats(tag ? tag : "?", samples));
+	}
+	std::sort(outStats.begin(), outStats.end(),
+		[](const ProfileScopeStats_t& a, const ProfileScopeStats_t& b) { return a.m_p99 > b.m_p99; });
 }
 
 void Profiler::Pause() {
@@ -164,8 +542,190 @@ bool Profiler::IsOpen() const {
 	return m_isOpen;
 }
 
-Profile_Node_t* Profiler::GetFrame(uint idx) const{
-	return m_frames[idx].get();
+Uptr<Profile_Node_t> Profiler::BuildFrameTree(uint frameIdx, uint threadIdx) const {
+	const ProfileFrame_t& frame = m_frames[frameIdx];
+	u64 frameEndHPC = frame.m_endHPC != 0 ? frame.m_endHPC : GetPerformanceCounter();
+	const std::deque<ProfileEvent_t>& events = m_threadHistories[threadIdx].m_events;
+
+	Uptr<Profile_Node_t> root = std::make_unique<Profile_Node_t>(GetThreadName(threadIdx));
+	root->SetStartHPC(frame.m_startHPC);
+	root->SetEndHPC(frameEndHPC);
+
+	Profile_Node_t* currentNode = root.get();
+	auto eventIt = std::lower_bound(events.begin(), events.end(), frame.m_startHPC,
+		[](const ProfileEvent_t& event, u64 hpc) { return event.m_hpc < hpc; });
+	for (; eventIt != events.end() && eventIt->m_hpc < frameEndHPC; ++eventIt) {
+		const char* tag = GetStringFromSid(eventIt->m_tag);
+		if (eventIt->m_type == PROFILE_EVENT_BEGIN) {
+			auto newNode = std::make_unique<Profile_Node_t>(tag ? tag : "?");
+			newNode->SetStartHPC(eventIt->m_hpc);
+			newNode->SetParent(currentNode);
+			currentNode->AddChild(std::move(newNode));
+			currentNode = currentNode->m_children.back().get();
+		}
+		else if (currentNode != root.get()) {
+			currentNode->SetEndHPC(eventIt->m_hpc);
+			currentNode = currentNode->m_parent;
+		}
+		else {
+			// began in an earlier frame, wraps everything this frame has seen so far
+			auto openedNode = std::make_unique<Profile_Node_t>(tag ? tag : "?");
+			openedNode->SetStartHPC(frame.m_startHPC);
+			openedNode->SetEndHPC(eventIt->m_hpc);
+			openedNode->SetParent(root.get());
+			openedNode->m_children = std::move(root->m_children);
+			root->m_children.clear();
+			for (auto& child : openedNode->m_children) {
+				child->SetParent(openedNode.get());
+			}
+			root->AddChild(std::move(openedNode));
+		}
+	}
+
+	// still running when the frame ended
+	while (currentNode != root.get()) {
+		currentNode->SetEndHPC(frameEndHPC);
+		currentNode = currentNode->m_parent;
+	}
+	return root;
+}
+
+bool Profiler::WriteChromeTrace(const std::string& filePath) const {
+	// only finished frames, the running one isn't drained yet
+	size_t numFrames = m_frames.size();
+	if (numFrames > 0 && m_frames.back().m_endHPC == 0) {
+		--numFrames;
+	}
+	u64 originHPC = numFrames > 0 ? m_frames.front().m_startHPC : 0;
+	u64 captureEndHPC = numFrames > 0 ? m_frames[numFrames - 1].m_endHPC : 0;
+
+	ChromeTraceWriter trace(filePath, "Profiler", originHPC);
+	if (!trace.IsOpen()) {
+		return false;
+	}
+
+	for (size_t frameIdx = 0; frameIdx < numFrames; ++frameIdx) {
+		trace.WriteFrame(m_frames[frameIdx].m_startHPC, m_frames[frameIdx].m_endHPC);
+	}
+
+	for (size_t threadIdx = 0; threadIdx < m_threadHistories.size(); ++threadIdx) {
+		trace.WriteThread((int)threadIdx, GetThreadName(threadIdx));
+
+		// begins and ends as they were recorded, ends of scopes that began before the history are left out
+		const std::deque<ProfileEvent_t>& events = m_threadHistories[threadIdx].m_events;
+		int depth = 0;
+		for (const ProfileEvent_t& event : events) {
+			if (event.m_hpc < originHPC) {
+				continue;
+			}
+			if (event.m_hpc >= captureEndHPC) {
+				break;
+			}
+			if (event.m_type == PROFILE_EVENT_END && depth == 0) {
+				continue;
+			}
+
+			const char* tag = GetStringFromSid(event.m_tag);
+			depth += event.m_type == PROFILE_EVENT_BEGIN ? 1 : -1;
+			trace.WriteEvent(Stringf("{\"name\":\"%s\",\"cat\":\"scope\",\"ph\":\"%s\",\"pid\":1,\"tid\":%d,\"ts\":%.3f}",
+				GetJsonEscapedString(tag ? tag : "?").c_str(), event.m_type == PROFILE_EVENT_BEGIN ? "B" : "E",
+				(int)threadIdx, trace.GetTimestamp(event.m_hpc)));
+		}
+
+		// still running when the capture ended
+		for (; depth > 0; --depth) {
+			trace.WriteEvent(Stringf("{\"ph\":\"E\",\"pid\":1,\"tid\":%d,\"ts\":%.3f}", (int)threadIdx, trace.GetTimestamp(captureEndHPC)));
+		}
+	}
+
+	return trace.Finish();
+}
+
+bool Profiler::WriteReport(const std::string& filePath, uint numFrames) const {
+	// only finished frames, the running one isn't drained yet
+	size_t numFinishedFrames = m_frames.size();
+	if (numFinishedFrames > 0 && m_frames.back().m_endHPC == 0) {
+		--numFinishedFrames;
+	}
+	numFrames = std::min(numFrames, (uint)numFinishedFrames);
+	if (numFrames == 0) {
+		return false;
+	}
+	std::ofstream os(filePath, std::ios::out | std::ios::trunc);
+	if (!os) {
+		return false;
+	}
+
+	bool isJson = filePath.size() >= 5 && filePath.compare(filePath.size() - 5, 5, ".json") == 0;
+	if (isJson) {
+		os << Stringf("{\"frames\":%u,\"threads\":[", numFrames);
+	}
+	else {
+		ProfilerReport::WriteCSVHeader(os);
+	}
+
+	std::vector<Uptr<Profile_Node_t>> frameTrees;
+	std::vector<Profile_Node_t*> roots;
+	for (uint threadIdx = 0; threadIdx < GetThreadCount(); ++threadIdx) {
+		frameTrees.clear();
+		roots.clear();
+		for (size_t frameIdx = numFinishedFrames - numFrames; frameIdx < numFinishedFrames; ++frameIdx) {
+			frameTrees.push_back(BuildFrameTree((uint)frameIdx, threadIdx));
+			roots.push_back(frameTrees.back().get());
+		}
+
+		ProfilerReport treeReport;
+		treeReport.GenerateTreeView(roots);
+		ProfilerReport flatReport;
+		flatReport.GenerateFlatView(roots);
+		if (m_isSortByTotal) {
+			flatReport.SortByTotalTime();
+		}
+		else {
+			flatReport.SortBySelfTime();
+		}
+
+		if (isJson) {
+			os << Stringf("%s\n{\"name\":\"%s\",\"tree\":", threadIdx > 0 ? "," : "", GetJsonEscapedString(GetThreadName(threadIdx)).c_str());
+			treeReport.WriteJson(os);
+			os << ",\"flat\":";
+			flatReport.WriteJson(os);
+			os << "}";
+		}
+		else {
+			treeReport.WriteCSV(os, GetThreadName(threadIdx));
+			flatReport.WriteCSV(os, GetThreadName(threadIdx));
+		}
+	}
+
+	if (isJson) {
+		os << "\n]}\n";
+	}
+	return os.good();
+}
+
+bool Profiler::StartReportDump(const std::string& filePath, int frameInterval) {
+	if (frameInterval < 0 || frameInterval > MAX_FRAMEHISTORY_COUNT) {
+		return false;
+	}
+	m_reportDumpPath = filePath;
+	m_reportDumpInterval = (uint)frameInterval;
+	m_numFramesSinceReportDump = 0;
+	m_numReportDumps = 0;
+	return true;
+}
+
+std::string Profiler::GetNumberedReportPath() const {
+	size_t extensionPos = m_reportDumpPath.find_last_of('.');
+	size_t directoryPos = m_reportDumpPath.find_last_of("/\\");
+	if (extensionPos == std::string::npos || (directoryPos != std::string::npos && extensionPos < directoryPos)) {
+		extensionPos = m_reportDumpPath.size();
+	}
+	return m_reportDumpPath.substr(0, extensionPos) + Stringf("_%04u", m_numReportDumps) + m_reportDumpPath.substr(extensionPos);
+}
+
+void Profiler::StopReportDump() {
+	m_reportDumpPath.clear();
 }
 
 u32 Profiler::GetFrameSize() const {
@@ -176,15 +736,20 @@ void Profiler::Update() {
 	UpdateInput();
 
 	if (!IsPaused()) {
-		// generate report for current frame(s)
-		auto& lastFrame = *(m_frames.end() - 2);
-		m_report = std::make_unique<ProfilerReport>();
-		if (m_isFlatView) {
-			m_report->GenerateFlatView(lastFrame.get());
-		}
-		else {
-			m_report->GenerateTreeView(lastFrame.get());
-		}
+		// generate report for the last finished frame
+		GenerateReport(m_frames.size() - 2);
+		GetScopeStats(m_scopeStats);
+	}
+}
+
+void Profiler::GenerateReport(uint frameIdx) {
+	Uptr<Profile_Node_t> frameTree = BuildFrameTree(frameIdx, m_viewThreadIdx);
+	m_report = std::make_unique<ProfilerReport>();
+	if (m_isFlatView) {
+		m_report->GenerateFlatView(frameTree.get());
+	}
+	else {
+		m_report->GenerateTreeView(frameTree.get());
 	}
 }
 
@@ -207,6 +772,13 @@ void Profiler::UpdateInput() {
 	if (g_theInput->WasKeyJustPressed(InputSystem::KEYBOARD_V)) {
 		m_isFlatView = !m_isFlatView;
 	}
+	if (g_theInput->WasKeyJustPressed(InputSystem::KEYBOARD_T)) {
+		// next thread's view of the same frames
+		m_viewThreadIdx = (m_viewThreadIdx + 1) % GetThreadCount();
+		if (IsPaused() && m_mouseSelectFrameIdx >= 0) {
+			GenerateReport(m_mouseSelectFrameIdx);
+		}
+	}
 	if (g_theInput->WasKeyJustPressed(InputSystem::MOUSE_LEFT)) {
 		if (m_sortByTotalBoxBound.IsPointInside(m_mousePos)) {
 			m_isSortByTotal = true;
@@ -221,13 +793,7 @@ void Profiler::UpdateInput() {
 			m_mouseSelectFrameIdx = (int)((m_mousePos.x - m_cpuVisualBoxStartX) / m_cpuVisualBoxFrameDeltaX);
 			m_mouseSelectFrameIdx -= MAX_FRAMEHISTORY_COUNT - m_frames.size();
 			if (m_mouseSelectFrameIdx >= 0) {
-				m_report = std::make_unique<ProfilerReport>();
-				if (m_isFlatView) {
-					m_report->GenerateFlatView(GetFrame(m_mouseSelectFrameIdx));
-				}
-				else {
-					m_report->GenerateTreeView(GetFrame(m_mouseSelectFrameIdx));
-				}
+				GenerateReport(m_mouseSelectFrameIdx);
 			}
 		}
 	}
@@ -238,7 +804,6 @@ void Profiler::UpdateInput() {
 	}
 }
 
-
 void Profiler::Render() const {
 	PROFILE_SCOPE_FUNTION();
 
@@ -250,6 +815,8 @@ void Profiler::Render() const {
 
 	DrawMemoryInfoText();
 
+	DrawScopeStatsText();
+
 	DrawCPUInfoText();
 
 	DrawCPUVIsualBox();
@@ -301,7 +868,42 @@ void Profiler::DrawReportInfoText() const {
 }
 
 void Profiler::DrawMemoryInfoText() const {
-//	g_theRenderer->DrawText(m_font.get(), Vector2(10.f, m_dimension.y - 90.f), Vector2(0.f, 1.f), "Memory:", 40.f);
+	FontRenderer* fontRenderer = g_theRHI->GetFontRenderer();
+	RHIOutput* output = fontRenderer->GetOutput();
+	if (output == nullptr) {
+		return;
+	}
+
+	constexpr float lineHeight = 18.f;
+	AABB2 bound(Vector2(10.f, 0.f), Vector2(output->GetWidth(), output->GetHeight() - 90.f));
+	fontRenderer->SetSize(lineHeight);
+	fontRenderer->SetAlignment(TEXT_ALIGN_LEFT, TEXT_ALIGN_TOP);
+	fontRenderer->DrawTextInBox("Memory:", bound, Rgba::WHITE);
+	for (int tagIdx = 0; tagIdx < NUM_MEMORY_TAGS; ++tagIdx) {
+		MemoryTagStats_t stats = GetMemoryTagStats((eMemoryTag)tagIdx);
+		bound.maxs.y -= lineHeight;
+		fontRenderer->DrawTextInBox("  " + GetMemoryTagStatsString(stats), bound, stats.IsOverBudget() ? Rgba::RED : Rgba::WHITE);
+	}
+}
+
+void Profiler::DrawScopeStatsText() const {
+	FontRenderer* fontRenderer = g_theRHI->GetFontRenderer();
+	RHIOutput* output = fontRenderer->GetOutput();
+	if (output == nullptr) {
+		return;
+	}
+
+	// under the memory text, the slowest scopes by p99
+	constexpr float lineHeight = 18.f;
+	constexpr size_t maxScopeCount = 10;
+	AABB2 bound(Vector2(10.f, 0.f), Vector2(output->GetWidth(), output->GetHeight() - 90.f - (NUM_MEMORY_TAGS + 2) * lineHeight));
+	fontRenderer->SetSize(lineHeight);
+	fontRenderer->SetAlignment(TEXT_ALIGN_LEFT, TEXT_ALIGN_TOP);
+	fontRenderer->DrawTextInBox(Stringf("Scopes over %u frames:", GetFrameSize()), bound, Rgba::WHITE);
+	for (size_t statsIdx = 0; statsIdx < m_scopeStats.size() && statsIdx < maxScopeCount; ++statsIdx) {
+		bound.maxs.y -= lineHeight;
+		fontRenderer->DrawTextInBox("  " + GetScopeStatsString(m_scopeStats[statsIdx]), bound, Rgba::WHITE);
+	}
 }
 
 void Profiler::DrawCPUInfoText() const {
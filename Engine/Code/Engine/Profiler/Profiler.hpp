@@ -1,20 +1,45 @@
 #pragma once
 #include "Engine/Core/type.hpp"
+#include "Engine/Core/StringId.hpp"
+#include "Engine/Core/RingQueue.hpp"
 #include "Engine/Math/AABB2.hpp"
 #include "Engine/Core/Time.hpp"
+#include <atomic>
 #include <string>
 #include <memory>
 #include <vector>
-#include <queue>
+#include <deque>
 #include <unordered_map>
 
 constexpr int MAX_FRAMEHISTORY_COUNT = 300;
+// events per thread between two MarkFrame, more are dropped
+constexpr size_t PROFILER_THREAD_RING_CAPACITY = 16 * 1024;
 
 struct ProfilerReport_Node_t;
 class ProfilerReport;
 
+enum eProfileEventType : u32 {
+	PROFILE_EVENT_BEGIN,
+	PROFILE_EVENT_END
+};
+
+struct ProfileEvent_t {
+	u64					m_hpc;
+	StringId			m_tag;
+	eProfileEventType	m_type;
+};
+
+// One thread's events. Shared by the thread and the profiler, which drains it every frame.
+struct ProfilerThread_t {
+	SPSCRingQueue<ProfileEvent_t>	m_events{ PROFILER_THREAD_RING_CAPACITY };
+	std::atomic<u32>				m_numDropped{ 0 };
+	std::atomic<bool>				m_isThreadAlive{ true };
+	const char*						m_name = nullptr;	// interned
+};
+
+// A scope in a frame, built from the events when a report or an export asks for it.
 struct Profile_Node_t {
-	Profile_Node_t(const std::string& tag) :m_tag(tag) {}
+	Profile_Node_t(const char* tag) :m_tag(tag) {}
 
 	void AddChild(std::unique_ptr<Profile_Node_t> child) { m_children.emplace_back(std::move(child)); }
 	void SetParent(Profile_Node_t* parent) { m_parent = parent; }
@@ -22,56 +47,129 @@ struct Profile_Node_t {
 	void SetEndHPC(u64 hpc) { m_endHPC = hpc; }
 	double GetDuration() const { return GetElapsedTime(m_startHPC, m_endHPC); }
 
-	std::string				m_tag;
+	const char*				m_tag;	// interned, lives as long as the program
 	Profile_Node_t*			m_parent = nullptr;
 	u64						m_startHPC = 0;
 	u64						m_endHPC = 0;
 	std::vector< std::unique_ptr<Profile_Node_t> >	m_children;
 };
 
+// How long one scope tag took over the frames in history it showed up in, in seconds.
+// A frame's sample is the tag's inclusive time in it, summed over threads.
+struct ProfileScopeStats_t {
+	const char*	m_tag = nullptr;
+	u32			m_numSamples = 0;
+	double		m_p50 = 0.0;
+	double		m_p95 = 0.0;
+	double		m_p99 = 0.0;
+	double		m_max = 0.0;
+	double		m_mean = 0.0;
+	double		m_stddev = 0.0;
+};
+
+struct ProfileFrame_t {
+	u64 m_startHPC = 0;
+	u64 m_endHPC = 0;	// 0 while the frame is running
+};
+
+// Every thread records its scopes into a ring of its own, no locks and no allocations per scope.
+// MarkFrame (main thread) moves the events into the frame history, frame trees and reports
+// are only built from it when something looks at them.
 class Profiler {
 public:
 	Profiler();
 	~Profiler();
 
 	void			Initialize();
-	void			Push(const std::string& tag);
-	void			Pop();
+	// any thread, false if nothing was recorded (paused, no profiler, ring full)
+	static bool		PushScope(StringId tag);
+	static void		PopScope(StringId tag);
+
 	void			MarkFrame();
 	void			Pause();
 	void			Resume();
 	void			ToggleOpen();
 	bool			IsPaused() const;
 	bool			IsOpen() const;
-	Profile_Node_t* GetFrame(uint idx) const; // can also get any previous frame in history
+	// any frame in history, the last one is still running. Thread 0 is the main thread
+	Uptr<Profile_Node_t> BuildFrameTree(uint frameIdx, uint threadIdx = 0) const;
 	u32				GetFrameSize() const;
+	const ProfileFrame_t& GetFrameTime(uint frameIdx) const { return m_frames[frameIdx]; }
+	u32				GetThreadCount() const { return (u32)m_threadHistories.size(); }
+	const char*		GetThreadName(uint threadIdx) const { return m_threadHistories[threadIdx].m_thread->m_name; }
+	u64				GetNumDroppedEvents() const { return m_numDroppedEvents; }
+	// over the finished frames in history, scopes sorted by p99, slowest first
+	ProfileScopeStats_t GetFrameStats() const;
+	void			GetScopeStats(std::vector<ProfileScopeStats_t>& outStats) const;
+	// a finished frame longer than this pauses the profiler on it, 0 turns it off
+	void			SetSpikeBudget(double seconds) { m_spikeBudgetSeconds = seconds; }
+	double			GetSpikeBudget() const { return m_spikeBudgetSeconds; }
+	// finished frames of every thread in the Chrome trace format (chrome://tracing, ui.perfetto.dev)
+	bool			WriteChromeTrace(const std::string& filePath) const;
+	// tree and flat reports of every thread over the last numFrames finished frames, .json or else csv
+	bool			WriteReport(const std::string& filePath, uint numFrames) const;
+	// every frameInterval frames writes the report of those frames to a numbered file next to filePath
+	// (Log/report.csv -> Log/report_0001.csv), plus one last numbered file on exit for the frames left over.
+	// 0 writes the whole history to filePath on exit only.
+	// Works with the view closed. False if the interval is negative or longer than the history
+	bool			StartReportDump(const std::string& filePath, int frameInterval);
+	void			StopReportDump();
 
 	void			Update();
 	void			Render() const;
 
 	void			DrawReportInfoText() const;
 	void			DrawMemoryInfoText() const;
+	void			DrawScopeStatsText() const;
 	void			DrawCPUInfoText() const;
 	void			DrawGeneralInfo() const;
 	void			DrawCPUVIsualBox() const;
 
 
 private:
+	struct ThreadHistory_t {
+		Sptr<ProfilerThread_t>		m_thread;
+		std::deque<ProfileEvent_t>	m_events;	// oldest first
+	};
+
+	void			CollectThreadEvents(bool keepEvents);
+	void			TrimThreadHistories();
+	void			RecordScopeSamples(const ProfileFrame_t& frame);
+	void			CheckForSpike();
+	void			GenerateReport(uint frameIdx);
+	std::string		GetNumberedReportPath() const;
 	void			UpdateInput();
 	void			RenderTreeView(ProfilerReport_Node_t* reportNode) const;
 	void			RenderFlatView() const;
 
 private:
-	std::deque<std::unique_ptr<Profile_Node_t>> m_frames;  //aka. history
+	std::deque<ProfileFrame_t>		m_frames;  //aka. history
+	std::vector<ThreadHistory_t>	m_threadHistories;
+	std::vector<ProfileEvent_t>		m_collectBuffer;
+	u64								m_numDroppedEvents = 0;
+	// per tag, one sample per frame it was in, oldest first. Trimmed with the frames
+	struct ScopeSample_t {
+		u64		m_frameStartHPC;
+		double	m_seconds;
+	};
+	std::unordered_map<StringId, std::deque<ScopeSample_t>> m_scopeSamples;
+	std::unordered_map<StringId, u64>	m_frameScopeHPCs;
+	std::vector<ProfileEvent_t>			m_scopeStack;
+	double								m_spikeBudgetSeconds = 0.0;
+	std::vector<ProfileScopeStats_t>	m_scopeStats;	// view
+	std::string							m_reportDumpPath;
+	uint								m_reportDumpInterval = 0;
+	uint								m_numFramesSinceReportDump = 0;
+	uint								m_numReportDumps = 0;
 	std::unique_ptr<ProfilerReport> m_report;
 
-	Profile_Node_t*				m_currentNode = nullptr;
 	bool						m_isPaused = false;
 	bool						m_isReadyToPause = false;
 	bool						m_isReadyToResume = false;
 	bool						m_isOpen = false;
 	bool						m_isFlatView = false;
 	bool						m_isMouseHidden = true;
+	uint						m_viewThreadIdx = 0;
 	// view data
 	Vector2						m_mousePos;
 	Vector2						m_dimension;
@@ -90,4 +188,4 @@ private:
 	bool						m_isSortByTotal = false;
 
 	mutable std::unordered_map<AABB2, ProfilerReport_Node_t*> m_reportTreeViewData;
-};
\ No newline at end of file
+};
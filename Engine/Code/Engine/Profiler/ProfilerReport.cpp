@@ -1,15 +1,18 @@
 #include "Engine/Profiler/ProfilerReport.hpp"
 #include "Engine/Profiler/Profiler.hpp"
 #include "Engine/Core/Time.hpp"
+#include "Engine/Core/StringUtils.hpp"
 #include <algorithm>
 
 void ProfilerReport_Node_t::GetInfoFromFrame(Profile_Node_t* frame) {
 	m_callCount++;
-	m_totalTime += GetElapsedTime(frame->m_startHPC, frame->m_endHPC);
-	m_selfTime = m_totalTime;
+	double totalTime = GetElapsedTime(frame->m_startHPC, frame->m_endHPC);
+	m_totalTime += totalTime;
+	m_selfTime += totalTime;
 	for (auto& child : frame->m_children) {
 		m_selfTime -= GetElapsedTime(child->m_startHPC, child->m_endHPC);
 	}
+	m_averageTimePerCall = m_totalTime / (double)m_callCount;
 	auto tempNode  = this;
 	while (tempNode->m_parent != nullptr) {
 		tempNode = tempNode->m_parent;
@@ -35,6 +38,7 @@ void ProfilerReport_Node_t::PopulateFlat(Profile_Node_t* frame) {
 		reportNode->m_callCount += tempNode.m_callCount;
 		reportNode->m_totalTime += tempNode.m_totalTime;
 		reportNode->m_selfTime += tempNode.m_selfTime;
+		reportNode->m_averageTimePerCall = reportNode->m_totalTime / (double)reportNode->m_callCount;
 		reportNode->m_selfPercent = (float)(reportNode->m_selfTime / GetElapsedTime(frame->m_startHPC, frame->m_endHPC));
 		PopulateFlat(child.get());
 	}
@@ -61,27 +65,112 @@ ProfilerReport::~ProfilerReport() {
 }
 
 void ProfilerReport::GenerateTreeView(Profile_Node_t* root) {
-	m_reportRoot = std::make_unique<ProfilerReport_Node_t>(root->m_tag);
-	m_reportRoot->PopulateTree(root);
+	GenerateTreeView(std::vector<Profile_Node_t*>{ root });
 }
 
 void ProfilerReport::GenerateFlatView(Profile_Node_t* root) {
-	m_reportRoot = std::make_unique<ProfilerReport_Node_t>(root->m_tag);
-	m_reportRoot->PopulateFlat(root);
-	m_reportRoot->GetInfoFromFrame(root);
+	GenerateFlatView(std::vector<Profile_Node_t*>{ root });
+}
+
+void ProfilerReport::GenerateTreeView(const std::vector<Profile_Node_t*>& roots) {
+	m_reportRoot = std::make_unique<ProfilerReport_Node_t>(roots.front()->m_tag);
+	m_isFlatView = false;
+	for (Profile_Node_t* root : roots) {
+		m_reportRoot->PopulateTree(root);
+	}
+}
+
+void ProfilerReport::GenerateFlatView(const std::vector<Profile_Node_t*>& roots) {
+	m_reportRoot = std::make_unique<ProfilerReport_Node_t>(roots.front()->m_tag);
+	m_isFlatView = true;
+	for (Profile_Node_t* root : roots) {
+		m_reportRoot->PopulateFlat(root);
+		m_reportRoot->GetInfoFromFrame(root);
+	}
 }
 
 void ProfilerReport::SortBySelfTime() {
 	m_sortedChildren.clear();
 	for (auto& child : m_reportRoot->m_children) {
-		m_sortedChildren[child.second->m_selfTime] = child.second.get();
+		m_sortedChildren.emplace(child.second->m_selfTime, child.second.get());
 	}
-	
 }
 
 void ProfilerReport::SortByTotalTime() {
 	m_sortedChildren.clear();
 	for (auto& child : m_reportRoot->m_children) {
-		m_sortedChildren[child.second->m_totalTime] = child.second.get();
+		m_sortedChildren.emplace(child.second->m_totalTime, child.second.get());
 	}
-}
\ No newline at end of file
+}
+
+//------------------------------------------------------------------------
+static double GetPercentOfRoot(double seconds, const ProfilerReport_Node_t* root) {
+	return root->m_totalTime > 0.0 ? seconds / root->m_totalTime * 100.0 : 0.0;
+}
+
+static void WriteCSVRow(std::ostream& os, const std::string& threadName, const char* view, const std::string& path,
+	int depth, const ProfilerReport_Node_t* node, const ProfilerReport_Node_t* root) {
+	os << GetCSVEscapedString(threadName) << ',' << view << ',' << GetCSVEscapedString(path) << ','
+		<< Stringf("%d,%llu,%.4f,%.4f,%.2f,%.2f,%.4f\n", depth, (unsigned long long)node->m_callCount,
+			node->m_totalTime * 1000.0, node->m_selfTime * 1000.0,
+			GetPercentOfRoot(node->m_totalTime, root), GetPercentOfRoot(node->m_selfTime, root),
+			node->m_averageTimePerCall * 1000.0);
+}
+
+static void WriteTreeCSVRows(std::ostream& os, const std::string& threadName, const std::string& path,
+	int depth, const ProfilerReport_Node_t* node, const ProfilerReport_Node_t* root) {
+	WriteCSVRow(os, threadName, "tree", path, depth, node, root);
+	for (auto& child : node->m_children) {
+		WriteTreeCSVRows(os, threadName, path + "/" + child.first, depth + 1, child.second.get(), root);
+	}
+}
+
+static void WriteJsonNode(std::ostream& os, const ProfilerReport_Node_t* node, const ProfilerReport_Node_t* root, bool withChildren) {
+	os << Stringf("{\"name\":\"%s\",\"calls\":%llu,\"total_ms\":%.4f,\"self_ms\":%.4f,\"total_percent\":%.2f,\"self_percent\":%.2f,\"avg_ms\":%.4f",
+		GetJsonEscapedString(node->m_name).c_str(), (unsigned long long)node->m_callCount,
+		node->m_totalTime * 1000.0, node->m_selfTime * 1000.0,
+		GetPercentOfRoot(node->m_totalTime, root), GetPercentOfRoot(node->m_selfTime, root),
+		node->m_averageTimePerCall * 1000.0);
+	if (withChildren) {
+		os << ",\"children\":[";
+		bool isFirst = true;
+		for (auto& child : node->m_children) {
+			os << (isFirst ? "" : ",");
+			WriteJsonNode(os, child.second.get(), root, true);
+			isFirst = false;
+		}
+		os << "]";
+	}
+	os << "}";
+}
+
+void ProfilerReport::WriteCSVHeader(std::ostream& os) {
+	os << "thread,view,path,depth,calls,total_ms,self_ms,total_percent,self_percent,avg_ms\n";
+}
+
+void ProfilerReport::WriteCSV(std::ostream& os, const std::string& threadName) const {
+	if (!m_isFlatView) {
+		WriteTreeCSVRows(os, threadName, m_reportRoot->m_name, 0, m_reportRoot.get(), m_reportRoot.get());
+		return;
+	}
+
+	WriteCSVRow(os, threadName, "flat", m_reportRoot->m_name, 0, m_reportRoot.get(), m_reportRoot.get());
+	for (auto& child : m_sortedChildren) {
+		WriteCSVRow(os, threadName, "flat", child.second->m_name, 1, child.second, m_reportRoot.get());
+	}
+}
+
+void ProfilerReport::WriteJson(std::ostream& os) const {
+	if (!m_isFlatView) {
+		WriteJsonNode(os, m_reportRoot.get(), m_reportRoot.get(), true);
+		return;
+	}
+
+	os << "[";
+	WriteJsonNode(os, m_reportRoot.get(), m_reportRoot.get(), false);
+	for (auto& child : m_sortedChildren) {
+		os << ",";
+		WriteJsonNode(os, child.second, m_reportRoot.get(), false);
+	}
+	os << "]";
+}
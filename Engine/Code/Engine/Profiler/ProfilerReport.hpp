@@ -5,6 +5,7 @@
 #include <string>
 #include <vector>
 #include <functional>
+#include <ostream>
 
 struct Profile_Node_t;
 
@@ -38,10 +39,19 @@ public:
 
 	void GenerateTreeView(Profile_Node_t* root);
 	void GenerateFlatView(Profile_Node_t* root);
+	// the frames summed up, roots are the frames' trees
+	void GenerateTreeView(const std::vector<Profile_Node_t*>& roots);
+	void GenerateFlatView(const std::vector<Profile_Node_t*>& roots);
 	void SortBySelfTime();
 	void SortByTotalTime();
 
+	// one row per node, tree nodes by path from the root, flat ones in sorted order
+	void WriteCSV(std::ostream& os, const std::string& threadName) const;
+	static void WriteCSVHeader(std::ostream& os);
+	void WriteJson(std::ostream& os) const;
+
 public:
 	std::unique_ptr<ProfilerReport_Node_t> m_reportRoot;
-	std::map<double, ProfilerReport_Node_t*, std::greater<double>> m_sortedChildren;  //only for flat view
+	std::multimap<double, ProfilerReport_Node_t*, std::greater<double>> m_sortedChildren;  //only for flat view
+	bool m_isFlatView = false;
 };
\ No newline at end of file
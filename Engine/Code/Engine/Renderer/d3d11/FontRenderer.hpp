@@ -25,6 +25,7 @@ public:
 
 	// will update device dependent resources
 	void BindOutput(RHIOutput* output);
+	RHIOutput* GetOutput() const { return m_output; }
 	void SetColor(const Rgba& color);
 
 	void DrawText(const std::string& str, const Rgba& color = Rgba::WHITE);
@@ -5,6 +5,7 @@
 #include "Engine/Core/Rgba.hpp"
 #include "Engine/Math/AABB2.hpp"
 #include "Engine/Math/Matrix44.hpp"
+#include "Engine/Core/TrackingAllocator.hpp"
 #include <array>
 
 template<typename VertType>
@@ -41,8 +42,8 @@ public:
 	bool							m_useIndices = true;
 	bool							m_isFinalized = false;
 
-	std::vector<VertType>			m_vertices;
-	std::vector<std::array<u32, 3>>	m_triangles;
+	std::vector<VertType, TrackedAllocatorSTL<VertType, MEMORY_TAG_MESHES>>						m_vertices;
+	std::vector<std::array<u32, 3>, TrackedAllocatorSTL<std::array<u32, 3>, MEMORY_TAG_MESHES>>	m_triangles;
 	ePrimitiveType					m_primitiveType;
 
 	std::unique_ptr<Buffer>			m_vertexBuffer;
@@ -22,8 +22,10 @@ std::unique_ptr<Texture2D> RHIDevice::CreateTexture2DFromSwapChain(RHIOutput* ou
 }
 
 std::unique_ptr<Texture2D> RHIDevice::CreateTexture2DFromFile(const std::string& filePath) {
-	std::unique_ptr<Image> image = std::make_unique<Image>(filePath, false);
+	return CreateTexture2DFromImage(std::make_unique<Image>(filePath, false));
+}
 
+std::unique_ptr<Texture2D> RHIDevice::CreateTexture2DFromImage(std::unique_ptr<Image> image) {
 	TextureDefinition_t texDefn;
 	texDefn.m_format = TEXTURE_FORMAT_R8G8B8A8_UNORM;
 	texDefn.m_dimension = Vector2(image->m_dimensions);
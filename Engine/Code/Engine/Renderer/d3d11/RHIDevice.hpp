@@ -29,6 +29,7 @@ public:
 	std::unique_ptr<Texture2D>		CreateTexture2D(const TextureDefinition_t& info);
 	std::unique_ptr<Texture2D>		CreateTexture2DFromSwapChain(RHIOutput* output);
 	std::unique_ptr<Texture2D>		CreateTexture2DFromFile(const std::string& filePath);
+	std::unique_ptr<Texture2D>		CreateTexture2DFromImage(std::unique_ptr<Image> image);
 	std::unique_ptr<Buffer>			CreateVertexBuffer(u32 size, bool dynamic, bool streamout, void* initialData);
 	std::unique_ptr<Buffer>			CreateIndexBuffer(u32 size, bool dynamic, void* initialData);
 	std::unique_ptr<Buffer>			CreateConstantBuffer(u32 size, bool dynamic, bool cpuUpdates, void* initialData);
@@ -1,5 +1,6 @@
 #include "Engine/Terrain/Terrain.hpp"
 #include "Engine/Math/MathUtils.hpp"
+#include "Engine/Core/ParallelFor.hpp"
 
 Terrain::Terrain() {
 	m_mesh = std::make_unique<Mesh<VertexPCUTBN>>(PRIMITIVE_TYPE_TRIANGLELIST, true);
@@ -17,7 +18,8 @@ void Terrain::GenerateFromHeightMap(u32 gridWidth, u32 gridHeight, float scale,
 	m_bitangents.clear();
 	m_normalizedColorValues.clear();
 
-	size_t heightValueSize = (gridWidth + 1) * (gridHeight + 1);
+	u32 vertexRowSize = gridWidth + 1;
+	size_t heightValueSize = vertexRowSize * (gridHeight + 1);
 	m_heightValues.resize(heightValueSize);
 	m_normals.resize(heightValueSize);
 	m_tangents.resize(heightValueSize);
@@ -25,9 +27,10 @@ void Terrain::GenerateFromHeightMap(u32 gridWidth, u32 gridHeight, float scale,
 	m_normalizedColorValues.resize(heightValueSize);
 
 	// First, calculate height values
-	for(u32 h = 0; h <= gridHeight; ++h){
+	ParallelFor(0, (int)gridHeight + 1, 16, [&](int row) {
+		u32 h = (u32)row;
 		for(u32 w = 0; w <= gridWidth; ++w){
-			u32 index = h * gridWidth + w;
+			u32 index = h * vertexRowSize + w;
 			float normalizedHeightValue = (float)heightMap.GetTexel(w, h).r / 255.f;
 			float scaledHeightValue = normalizedHeightValue * scale;
 			m_heightValues[index] = scaledHeightValue;
@@ -35,15 +38,17 @@ void Terrain::GenerateFromHeightMap(u32 gridWidth, u32 gridHeight, float scale,
 			Vector4 normalizedColorValue = colorMap.GetTexel(w, h).GetAsFloats();
 			m_normalizedColorValues[index] = normalizedColorValue;
 		}
-	}
+	});
 
 	// Second, calculate TBN
-	for (u32 h = 0; h < gridHeight; ++h) {
-		for (u32 w = 0; w < gridWidth; ++w) {\
-			u32 bl_idx = h * gridWidth + w;
-			u32 br_idx = h * gridWidth + w + 1;
-			u32 tl_idx = (h + 1) * gridWidth + w;
-			u32 tr_idx = (h + 1) * gridWidth + w + 1;
+	// A row of quads adds to the vertices of its own row and the one above,
+	// so all even rows can run at once, then all odd rows
+	auto accumulateRowTBN = [&](u32 h) {
+		for (u32 w = 0; w < gridWidth; ++w) {
+			u32 bl_idx = h * vertexRowSize + w;
+			u32 br_idx = h * vertexRowSize + w + 1;
+			u32 tl_idx = (h + 1) * vertexRowSize + w;
+			u32 tr_idx = (h + 1) * vertexRowSize + w + 1;
 			
 			Vector3 blPos((float)w, m_heightValues[bl_idx],		(float)h);
 			Vector3 brPos((float)w + 1, m_heightValues[br_idx], (float)h);
@@ -76,24 +81,24 @@ void Terrain::GenerateFromHeightMap(u32 gridWidth, u32 gridHeight, float scale,
 			m_bitangents[br_idx] += bitangent_face2;
 			m_bitangents[tr_idx] += bitangent_face2;
 		}
-	}
-
-	for(auto& normal : m_normals){
-		normal = normal.GetNormalized();
-	}
-	for(auto& tangent : m_tangents){
-		tangent = tangent.GetNormalized();
-	}
-	for(auto& bitangent : m_bitangents){
-		bitangent = bitangent.GetNormalized();
-	}
+	};
+	int evenRowCount = ((int)gridHeight + 1) / 2;
+	int oddRowCount = (int)gridHeight / 2;
+	ParallelFor(0, evenRowCount, 8, [&](int i) { accumulateRowTBN((u32)i * 2); });
+	ParallelFor(0, oddRowCount, 8, [&](int i) { accumulateRowTBN((u32)i * 2 + 1); });
+
+	ParallelFor(0, (int)heightValueSize, 1024, [&](int i) {
+		m_normals[i] = m_normals[i].GetNormalized();
+		m_tangents[i] = m_tangents[i].GetNormalized();
+		m_bitangents[i] = m_bitangents[i].GetNormalized();
+	});
 
 	for (u32 h = 0; h < gridHeight; ++h) {
 		for (u32 w = 0; w < gridWidth; ++w) {
-			u32 bl_idx = h * gridWidth + w;
-			u32 br_idx = h * gridWidth + w + 1;
-			u32 tl_idx = (h + 1) * gridWidth + w;
-			u32 tr_idx = (h + 1) * gridWidth + w + 1;
+			u32 bl_idx = h * vertexRowSize + w;
+			u32 br_idx = h * vertexRowSize + w + 1;
+			u32 tl_idx = (h + 1) * vertexRowSize + w;
+			u32 tr_idx = (h + 1) * vertexRowSize + w + 1;
 
 			Vector3 blPos((float)w, m_heightValues[bl_idx],		(float)h);
 			Vector3 brPos((float)w + 1, m_heightValues[br_idx], (float)h);
@@ -131,7 +136,7 @@ void Terrain::GenerateFromHeightMap(u32 gridWidth, u32 gridHeight, float scale,
 			m_mesh->PushVertex(VertexPCUTBN(tlPos, tlColor, tlUV, tlNormal, tlTangent, tlBitangent));
 			m_mesh->PushVertex(VertexPCUTBN(trPos, trColor, trUV, trNormal, trTangent, trBitangent));
 
-			u32 startIndex = bl_idx * 4;
+			u32 startIndex = (h * gridWidth + w) * 4;
 			m_mesh->PushTriangle(startIndex, startIndex + 1, startIndex + 2);
 			m_mesh->PushTriangle(startIndex + 1, startIndex + 3, startIndex + 2);
 		}
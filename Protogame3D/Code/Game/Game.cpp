@@ -142,7 +142,7 @@ void Game::Update() {
 
 		SpawnEntity(10.f, m_mainCamera3D->m_transform.GetWorldPosition(), Rgba::GREEN);
 
-		g_theEventSystem->FireEvents("OnButtonPress", 10.f, m_mainCamera3D->m_transform.GetWorldPosition(), Rgba(0.f, 1.f, 0.f, 1.f));
+		g_theEventSystem->FireEvent(SID("OnButtonPress"), 10.f, m_mainCamera3D->m_transform.GetWorldPosition(), Rgba(0.f, 1.f, 0.f, 1.f));
 	}
 
 
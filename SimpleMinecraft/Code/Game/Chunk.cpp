@@ -2,6 +2,7 @@
 #include "Engine/Core/EngineCommon.hpp"
 #include "Engine/Core/ResourceManager.hpp"
 #include "Engine/Core/FileSystem.hpp"
+#include "Engine/Core/TrackingAllocator.hpp"
 #include "Engine/Renderer/d3d11/RHIInstance.hpp"
 #include "Engine/Renderer/d3d11/ImmediateRenderer.hpp"
 #include "Engine/Renderer/d3d11/SpriteSheet.hpp"
@@ -17,6 +18,14 @@ Chunk::~Chunk() {
 
 }
 
+void* Chunk::operator new(size_t size) {
+	return TrackingAllocator::Get(MEMORY_TAG_CHUNKS).Alloc(size, alignof(Chunk));
+}
+
+void Chunk::operator delete(void* ptr, size_t size) {
+	TrackingAllocator::Get(MEMORY_TAG_CHUNKS).Free(ptr, size, alignof(Chunk));
+}
+
 void Chunk::Update(float deltaSeconds) {
 
 }
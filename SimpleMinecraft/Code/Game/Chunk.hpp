@@ -38,6 +38,9 @@ class Chunk {
 	friend class BlockLocator;
 public:
 	Chunk(IntVector2 chunkCoords);
+	// counted against the chunks memory budget
+	static void* operator new(size_t size);
+	static void operator delete(void* ptr, size_t size);
 	~Chunk();
 
 	void			Update(float deltaSeconds);
@@ -8,9 +8,11 @@
 #include "Engine/Core/DevConsole.hpp"
 #include "Engine/Core/ErrorWarningAssert.hpp"
 #include "Engine/Core/Thread.hpp"
+#include "Engine/Core/FrameAllocator.hpp"
 #include "Engine/Core/Logger.hpp"
 #include "Engine/Core/DebugDrawSystem.hpp"
 #include "Engine/Core/ResourceManager.hpp"
+#include "Engine/Core/Task.hpp"
 #include "Engine/Core/Blackboard.hpp"
 #include "Engine/Core/EventSystem.hpp"
 #include "Engine/Profiler/ProfileScope.hpp"
@@ -18,6 +20,7 @@
 #include "Engine/Math/Matrix44.hpp"
 #include "Game/TheApp.hpp"
 #include "ThirdParty/pugixml/pugixml.hpp"
+#include <fstream>
 
 Uptr<TheApp> g_theApp;
 Uptr<RHIOutput> g_mainOutput;
@@ -50,6 +53,22 @@ static bool Command_RegisterStringId(Command& cmd) {
 	}
 }
 
+static bool Command_SetConfig(Command& cmd) {
+	std::string key;
+	std::string value;
+	if (cmd.GetNextArg<std::string>(key) && cmd.GetNextArg<std::string>(value)) {
+		if (!g_gameConfig->SetValue(key, value)) {
+			ConsolePrintf(Rgba::RED, "%s can't be %s, kept the old value", key.c_str(), value.c_str());
+			return true;
+		}
+		ConsolePrintf("%s = %s", key.c_str(), value.c_str());
+		return true;
+	}
+	else {
+		return false;
+	}
+}
+
 static bool Command_ToggleDebugMode(Command& cmd) {
 	if (!cmd.m_args.empty()) {
 		return false;
@@ -160,6 +179,8 @@ TheApp::~TheApp() {
 }
 
 TheApp::TheApp() {
+	ThreadManager::SetCurrentThreadName("Main");
+
 	// Test case
 	NamedProperties p;
 	p.Set<std::string>("FirstName", "Rui");
@@ -192,13 +213,20 @@ TheApp::TheApp() {
 void TheApp::PostStartUp() {
 	//--------------------------------------------------------------------
 	// Test job
-	g_theJobSystem->CreateWorkerThread("Alpha");
-	g_theJobSystem->CreateWorkerThread("Beta");
+	// one compute worker per core next to the main thread and the IO worker, left to the OS to place
+	int computeWorkerCount = ThreadManager::GetRecommendedWorkerCount() - 1;
+	if (computeWorkerCount < 1) {
+		computeWorkerCount = 1;
+	}
+	for (int workerIdx = 0; workerIdx < computeWorkerCount; ++workerIdx) {
+		g_theJobSystem->CreateWorkerThread(Stringf("Compute %d", workerIdx), JOB_CHANNEL_MASK_COMPUTE);
+	}
+	g_theJobSystem->CreateWorkerThread("IO", JOB_CHANNEL_MASK_IO);
 
 	Uptr<TestJob> testJob1 = std::make_unique<TestJob>(5.f);
 	Uptr<TestJob> testJob2 = std::make_unique<TestJob>(3.f);
-	g_theJobSystem->QueueJob(std::move(testJob1));
-	g_theJobSystem->QueueJob(std::move(testJob2));
+	JobHandle testHandle1 = g_theJobSystem->QueueJob(std::move(testJob1));
+	g_theJobSystem->QueueJob(std::move(testJob2), { testHandle1 });
 
 	//--------------------------------------------------------------------
 
@@ -219,6 +247,15 @@ void TheApp::PostStartUp() {
 	g_gameConfig = std::make_unique<Blackboard>();
 	g_gameConfig->PopulateFromXmlElementAttributes(doc);
 
+	// unattended runs write the profiler report to disk, nothing needs to be open
+	std::string profilerReportFile = g_gameConfig->GetValue("ProfilerReportFile", "");
+	if (!profilerReportFile.empty()) {
+		int profilerReportInterval = g_gameConfig->GetValue("ProfilerReportInterval", 0);
+		if (!g_theProfiler->StartReportDump(profilerReportFile, profilerReportInterval)) {
+			LogErrorf("ProfilerReportInterval %d has to be 0 to %d frames, no profiler report.", profilerReportInterval, MAX_FRAMEHISTORY_COUNT);
+		}
+	}
+
 	m_game = std::make_unique<Game>();
 }
 
@@ -226,18 +263,31 @@ void TheApp::RegisterDefaultCommands() {
 	CommandDefinition::Register("quit", "[N/A] Exit the game.", Command_Quit);
 	CommandDefinition::Register("get_stringid", "[\"string\"] Get StringId for a standard string.", Command_RegisterStringId);
 	CommandDefinition::Register("debug_mode", "[N/A] Toggle debug mode.", Command_ToggleDebugMode);
+	CommandDefinition::Register("config_set", "[string key] [string value] Set a game config value, takes effect right away.", Command_SetConfig);
 	CommandDefinition::Register("log_test", "[int] Log Test. Argument is thread number that's going to be created.", Command_LogTest);
 }
 
 void TheApp::LoadDefaultAssets() {
 	g_theResourceManager->LoadSampler("linear");
 	g_theResourceManager->LoadSampler("nearest");
-	g_theResourceManager->LoadTexture2D("default", "Data/Images/white.png");
-	g_theResourceManager->LoadTexture2D("terrain_test", "Data/Images/terrain_test.png");
-	g_theResourceManager->LoadTexture2D("terrain_diffuse", "Data/Images/terrain_diffuse.png");
-	g_theResourceManager->LoadTexture2D("terrain_normal", "Data/Images/terrain_normal.png");
-	g_theResourceManager->LoadTexture2D("test_opengl", "Data/Images/test_opengl.png");
-	g_theResourceManager->LoadTexture2D("skybox_bluesky", "Data/Images/skybox_galaxy.png");
+	// the textures read and decode on workers side by side, the materials below want them all in
+	std::vector<Task<void>> textureLoads;
+	textureLoads.push_back(g_theResourceManager->LoadTexture2DAsync("default", "Data/Images/white.png"));
+	textureLoads.push_back(g_theResourceManager->LoadTexture2DAsync("terrain_test", "Data/Images/terrain_test.png"));
+	textureLoads.push_back(g_theResourceManager->LoadTexture2DAsync("terrain_diffuse", "Data/Images/terrain_diffuse.png"));
+	textureLoads.push_back(g_theResourceManager->LoadTexture2DAsync("terrain_normal", "Data/Images/terrain_normal.png"));
+	textureLoads.push_back(g_theResourceManager->LoadTexture2DAsync("test_opengl", "Data/Images/test_opengl.png"));
+	textureLoads.push_back(g_theResourceManager->LoadTexture2DAsync("skybox_bluesky", "Data/Images/skybox_galaxy.png"));
+	for (Task<void>& textureLoad : textureLoads) {
+		textureLoad.Start();
+	}
+	// they finish on the main thread, so keep running its jobs until the last one is in
+	for (Task<void>& textureLoad : textureLoads) {
+		while (!textureLoad.IsReady()) {
+			g_theJobSystem->FinishAllCompletedJobs();
+			std::this_thread::yield();
+		}
+	}
 	g_theResourceManager->LoadSpriteSheet("terrain_32x32", "Data/Images/terrain_32x32.png", IntVector2(32, 32));
 
 	g_theResourceManager->LoadShaderProgram("default_vs", "Data/Shaders/hlsl/default_vs.hlsl", SHADER_TYPE_VERTEX_SHADER);
@@ -256,9 +306,12 @@ void TheApp::LoadDefaultAssets() {
 
 void TheApp::RunFrame() {
 	g_theProfiler->MarkFrame();
+	g_theJobSystem->MarkFrame();
 	g_theMasterClock->BeginFrame();
+	g_theFrameAllocator.BeginFrame();
 	g_theInput->BeginFrame();
 	g_theAudio->BeginFrame();
+	g_theEventSystem->DispatchQueuedEvents();
 	Update();
 	Render();
 	g_theAudio->EndFrame();
@@ -346,7 +399,7 @@ void TheApp::UpdateInput() {
 		g_theConsole->ToggleOpen();
 	}
 	if (g_theInput->WasKeyJustPressed(InputSystem::KEYBOARD_E)) {
-		g_theEventSystem->FireEvents("OnButtonHit", 4, 43.5f, Rgba::BLACK);
+		g_theEventSystem->FireEvent(SID("OnButtonHit"), 4, 43.5f, Rgba::BLACK);
 	}
 }
 
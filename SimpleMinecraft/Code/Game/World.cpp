@@ -16,6 +16,7 @@
 #include "Game/TheApp.hpp"
 #include "Game/Player.hpp"
 #include "Game/GameCamera.hpp"
+#include <thread>
 
 World::World() {
 	//--------------------------------------------------------------------------
@@ -61,9 +62,11 @@ World::World() {
 	ActivateChunk(IntVector2(0, -1));
 
 	//--------------------------------------------------------------------
-	// Set fog range
-	g_theRHI->GetImmediateRenderer()->SetFogStart((float)g_gameConfig->GetValue("ChunkActivationRange", 20) * 0.5f);
-	g_theRHI->GetImmediateRenderer()->SetFogEnd((float)g_gameConfig->GetValue("ChunkActivationRange", 20) - 16.f);
+	// Set fog range, follows the activation range when it's tuned
+	m_chunkActivationRange = g_gameConfig->GetHandle(SID("ChunkActivationRange"), 20);
+	m_stepsPerMeter = g_gameConfig->GetHandle(SID("StepsPerMeter"), 10);
+	ApplyFogRange();
+	m_configWatchId = g_gameConfig->Watch(SID("ChunkActivationRange"), [this](StringId, const std::string&) { ApplyFogRange(); });
 
 	//--------------------------------------------------------------------
 	// Set default indoor and outdoor color
@@ -86,13 +89,18 @@ World::World() {
 }
 
 World::~World() {
+	g_gameConfig->Unwatch(m_configWatchId);
+
+	// loads still in flight would add chunks after we deactivated them
+	WaitForChunkTasks();
 	DeactivateAllChunks();
+	WaitForChunkTasks();
 }
 
 void World::Update(float deltaSeconds) {
 	// Some debug info
 	if (g_theApp->m_isDebugMode) {
-		DebugString(0.f, Stringf("Range: %dm,  Active chunks: %d", g_gameConfig->GetValue("ChunkActivationRange", 20), m_activeChunks.size()), Rgba::YELLOW, Rgba::YELLOW);
+		DebugString(0.f, Stringf("Range: %dm,  Active chunks: %d", m_chunkActivationRange.Get(), m_activeChunks.size()), Rgba::YELLOW, Rgba::YELLOW);
 		DebugString(0.f, Stringf("World time: %.2f ", m_worldTime), Rgba::YELLOW, Rgba::YELLOW);
 		DebugString(0.f, "Debug mode: On!", Rgba::YELLOW, Rgba::YELLOW);
 	}
@@ -124,6 +132,8 @@ void World::Update(float deltaSeconds) {
 	//m_raycastResult = StepAndSampleRaycast(pos, dir, 8.f);
 	m_raycastResult = FastVoxelRaycast(pos, dir, 12.f);
 
+	UpdateChunkTasks();
+
 	FindAndActivateNearestChunkInRange();
 
 	FindAndDeactivateFarthestChunkOutRange();
@@ -178,8 +188,31 @@ Chunk* World::ActivateChunk(const IntVector2& chunkCoords) {
 		newChunk->GenerateBLocks();
 	}
 
+	return AddActiveChunk(std::move(newChunk));
+}
+
+Task<void> World::ActivateChunkAsync(IntVector2 chunkCoords) {
+	Uptr<Chunk> newChunk = std::make_unique<Chunk>(chunkCoords);
+
+	// the chunk isn't in the world yet, so nobody else touches it while it loads
+	co_await ResumeOnWorker(JOB_CHANNEL_MASK_IO);
+	std::string chunkFileName = Stringf("Data/Saves/Chunk_%d,%d.chunk", chunkCoords.x, chunkCoords.y);
+	if (FileSystem::Exists(chunkFileName)) {
+		newChunk->LoadFromFile(chunkFileName.c_str());
+	}
+	else {
+		co_await ResumeOnWorker(JOB_CHANNEL_MASK_COMPUTE);
+		newChunk->GenerateBLocks();
+	}
+
+	co_await ResumeOnMainThread();
+	AddActiveChunk(std::move(newChunk));
+}
+
+Chunk* World::AddActiveChunk(Uptr<Chunk> newChunk) {
 	//--------------------------------------------------------------------
 	// Add to world
+	IntVector2 chunkCoords = newChunk->m_chunkCoords;
 	Chunk* chunkPtr = newChunk.get();
 	m_activeChunks.insert({ chunkCoords, std::move(newChunk) });
 
@@ -206,11 +239,11 @@ Chunk* World::ActivateChunk(const IntVector2& chunkCoords) {
 
 	//--------------------------------------------------------------------
 	// Mark sky, mark blocks emit light dirty
+	// Serial on purpose, a column scan is too little work to pay for a job
 	for (int blockY = 0; blockY < CHUNK_SIZE_Y; ++blockY) {
 		for (int blockX = 0; blockX < CHUNK_SIZE_X; ++blockX) {
 			for (int blockZ = CHUNK_SIZE_Z - 1; blockZ >= 0; --blockZ) {
 				int blockIndex = chunkPtr->GetBlockIndexForBlockCoords(IntVector3(blockX, blockY, blockZ));
-				BlockLocator bl(chunkPtr, blockIndex);
 				Block& b = chunkPtr->m_blocks[blockIndex];
 				if (b.IsFullOpaque()) {
 					break;
@@ -293,9 +326,13 @@ void World::DeactivateChunk(const IntVector2& chunkCoords) {
 		chunk->m_southNeighbor->m_northNeighbor = nullptr;
 	}
 
-	// Needs saving?
+	// Needs saving? The write happens on a worker, the chunk goes with it
 	if (chunk->m_needsSaving) {
-		chunk->SaveToFile();
+		Uptr<Chunk> chunkToSave = std::move(m_activeChunks.at(chunkCoords));
+		chunkToSave->m_mesh.reset();
+		Task<void>& saveTask = m_chunkTasks[chunkCoords];
+		saveTask = SaveChunkAsync(std::move(chunkToSave));
+		saveTask.Start();
 	}
 
 	m_activeChunks.erase(chunkCoords);
@@ -308,6 +345,32 @@ void World::DeactivateAllChunks() {
 	}
 }
 
+Task<void> World::SaveChunkAsync(Uptr<Chunk> chunk) {
+	co_await ResumeOnWorker(JOB_CHANNEL_MASK_IO);
+	chunk->SaveToFile();
+}
+
+void World::UpdateChunkTasks() {
+	for (auto it = m_chunkTasks.begin(); it != m_chunkTasks.end(); ) {
+		if (it->second.IsReady()) {
+			it = m_chunkTasks.erase(it);
+		}
+		else {
+			++it;
+		}
+	}
+}
+
+void World::WaitForChunkTasks() {
+	UpdateChunkTasks();
+	while (!m_chunkTasks.empty()) {
+		// loads finish on the main thread
+		g_theJobSystem->FinishAllCompletedJobs();
+		std::this_thread::yield();
+		UpdateChunkTasks();
+	}
+}
+
 void World::RenderChunks() const {
 	g_theRHI->GetImmediateRenderer()->BindMaterial(g_theResourceManager->GetMaterial("smc"));
 
@@ -378,7 +441,7 @@ void World::FindAndActivateNearestChunkInRange() {
 	IntVector2 myChunkCoords = GetCameraCurrentChunkCoords();
 	Vector2 myChunkPosition(myChunkCoords.x * CHUNK_SIZE_X, myChunkCoords.y * CHUNK_SIZE_Y);
 	IntVector2 nearestMissingChunkCoords = myChunkCoords;
-	int activationRange = g_gameConfig->GetValue("ChunkActivationRange", 20);
+	int activationRange = m_chunkActivationRange.Get();
 	int minDistanceSquared = activationRange * activationRange;
 	
 	for (int x = myChunkCoords.x - activationRange; x < myChunkCoords.x + activationRange; ++x) {
@@ -387,7 +450,7 @@ void World::FindAndActivateNearestChunkInRange() {
 			int distanceSquared = (chunkPosition - myChunkPosition).GetLengthSquared();
 			if (distanceSquared <= activationRange * activationRange && distanceSquared <= minDistanceSquared) {
 				IntVector2 chunkCoords(x, y);
-				if (m_activeChunks.find(chunkCoords) == m_activeChunks.end()) {
+				if (m_activeChunks.find(chunkCoords) == m_activeChunks.end() && m_chunkTasks.find(chunkCoords) == m_chunkTasks.end()) {
 					nearestMissingChunkCoords = chunkCoords;
 					minDistanceSquared = distanceSquared;
 				}
@@ -396,14 +459,16 @@ void World::FindAndActivateNearestChunkInRange() {
 	}
 
 	if (nearestMissingChunkCoords != myChunkCoords) {
-		ActivateChunk(nearestMissingChunkCoords);
+		Task<void>& loadTask = m_chunkTasks[nearestMissingChunkCoords];
+		loadTask = ActivateChunkAsync(nearestMissingChunkCoords);
+		loadTask.Start();
 	}
 }
 
 void World::FindAndDeactivateFarthestChunkOutRange() {
 	IntVector2 myChunkCoords = GetCameraCurrentChunkCoords();
 	Vector2 myChunkPosition(myChunkCoords.x * CHUNK_SIZE_X, myChunkCoords.y * CHUNK_SIZE_Y);
-	int activationRange = g_gameConfig->GetValue("ChunkActivationRange", 20) + 16;
+	int activationRange = m_chunkActivationRange.Get() + 16;
 	int maxDistanceSquared = 0;
 	IntVector2 farthestChunkCoordsToDelete = myChunkCoords;
 
@@ -472,7 +537,10 @@ void World::UpdateInput(float deltaSeconds) {
 	//--------------------------------------------------------------------
 	// Debug key U
 	if (g_theInput->WasKeyJustPressed(InputSystem::KEYBOARD_U)) {
+		WaitForChunkTasks();
 		DeactivateAllChunks();
+		// the saves have to land before the chunks are read back
+		WaitForChunkTasks();
 		IntVector2 currentChunkCoords = GetCameraCurrentChunkCoords();
 		ActivateChunk(currentChunkCoords);
 	}
@@ -568,7 +636,7 @@ RaycastResult3D_t World::StepAndSampleRaycast(const Vector3& startPos, const Vec
 
 	BlockLocator prevBlock = startBlock;
 	IntVector3 prevBlockCoords = startBlockCoords;
-	int stepsPerMeter = g_gameConfig->GetValue("StepsPerMeter", 10);
+	int stepsPerMeter = m_stepsPerMeter.Get();
 	int numSteps = stepsPerMeter * maxDistance;
 	for (int i = 0; i < numSteps; ++i) {
 		Vector3 newPos = startPos + (((float)i / numSteps) * maxDistance) * forwardNormal;
@@ -1222,6 +1290,11 @@ void World::MarkBlockLightingDirty(BlockLocator& bl) {
 	// else do nothing
 }
 
+void World::ApplyFogRange() const {
+	g_theRHI->GetImmediateRenderer()->SetFogStart((float)m_chunkActivationRange.Get() * 0.5f);
+	g_theRHI->GetImmediateRenderer()->SetFogEnd((float)m_chunkActivationRange.Get() - 16.f);
+}
+
 void World::UpdateWorldTime(float deltaSeconds) {
 	float worldDeltaSec = deltaSeconds * m_timeScale;
 	m_worldTime += worldDeltaSec / (60.f * 60.f * 24.f);
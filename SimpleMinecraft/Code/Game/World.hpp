@@ -2,6 +2,8 @@
 #include "Engine/Math/IntVector2.hpp"
 #include "Engine/Math/Vector4.hpp"
 #include "Engine/Core/type.hpp"
+#include "Engine/Core/Task.hpp"
+#include "Engine/Core/Blackboard.hpp"
 #include "Game/Chunk.hpp"
 #include "Game/BlockLocator.hpp"
 #include <map>
@@ -36,8 +38,13 @@ public:
 
 private:
 	Chunk*				ActivateChunk(const IntVector2& chunkCoords);
+	Task<void>			ActivateChunkAsync(IntVector2 chunkCoords);
+	Chunk*				AddActiveChunk(Uptr<Chunk> newChunk);
 	void				DeactivateChunk(const IntVector2& chunkCoords);
 	void				DeactivateAllChunks();
+	static Task<void>	SaveChunkAsync(Uptr<Chunk> chunk);
+	void				UpdateChunkTasks();
+	void				WaitForChunkTasks();
 	void				RenderChunks() const;
 	IntVector2			GetCameraCurrentChunkCoords() const;
 	Vector3				GetCameraCurrentPosition() const;
@@ -61,6 +68,7 @@ private:
 	void				ProcessDirtyLightingBLock();
 	void				MarkBlockLightingDirty(BlockLocator& bl);
 
+	void				ApplyFogRange() const;
 	void				UpdateWorldTime(float deltaSeconds);
 	void				ApplyLightningStrikeToSkyColor();
 	void				ApplyGlowstoneFlickerToIndoorLight();
@@ -72,6 +80,7 @@ private:
 
 public:
 	std::map<IntVector2, Uptr<Chunk>> m_activeChunks;
+	std::map<IntVector2, Task<void>> m_chunkTasks; // loads and saves in flight, at most one per chunk
 
 	Uptr<Camera>		m_mainCamera2D;
 	Uptr<GameCamera>	m_mainCamera3D;
@@ -90,4 +99,9 @@ public:
 
 
 	Uptr<Player> m_player;
+
+	// read every frame, cached from g_gameConfig
+	BlackboardValue<int> m_chunkActivationRange;
+	BlackboardValue<int> m_stepsPerMeter;
+	u32 m_configWatchId = 0;
 };
\ No newline at end of file